@@ -0,0 +1,87 @@
+#include "BassBudCore.h"
+#include "../../Default/Source/PitchTracker.h"
+#include <new>
+
+struct bassbud_tracker
+{
+    PitchTracker tracker;
+};
+
+namespace
+{
+    bassbud_result toCResult(const PitchResult& result)
+    {
+        return { result.pitch, result.midiNoteNumber, result.string, result.fret, result.confidence, result.provisional ? 1 : 0,
+                 result.voicedProbability };
+    }
+
+    bool isValidConfiguration(double sampleRate, int windowSize, int hopSize)
+    {
+        return sampleRate > 0.0 && windowSize > 0 && hopSize > 0 && hopSize <= windowSize;
+    }
+}
+
+extern "C"
+{
+
+bassbud_tracker* bassbud_tracker_create(double sample_rate, int window_size, int hop_size)
+{
+    const int standardTuning[] = { 28, 33, 38, 43 };
+    return bassbud_tracker_create_for_instrument(sample_rate, window_size, hop_size, standardTuning, 4, 24);
+}
+
+bassbud_tracker* bassbud_tracker_create_for_instrument(double sample_rate, int window_size, int hop_size,
+                                                        const int* open_string_notes, int num_strings, int num_frets)
+{
+    if (! isValidConfiguration(sample_rate, window_size, hop_size) || open_string_notes == nullptr
+        || num_strings < 1 || num_strings > InstrumentModel::Instrument::maxStrings)
+        return nullptr;
+
+    // Exceptions must not cross the C boundary, so allocation failures become a null tracker
+    try
+    {
+        auto* handle = new bassbud_tracker();
+        handle->tracker.prepare(sample_rate, window_size, hop_size,
+                                InstrumentModel::Instrument(open_string_notes, num_strings, num_frets));
+        return handle;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void bassbud_tracker_destroy(bassbud_tracker* tracker)
+{
+    delete tracker;
+}
+
+void bassbud_tracker_reset(bassbud_tracker* tracker)
+{
+    tracker->tracker.reset();
+}
+
+void bassbud_tracker_process(bassbud_tracker* tracker, const float* samples, int num_samples,
+                             bassbud_frame_callback on_frame, void* user_data)
+{
+    tracker->tracker.process(samples, num_samples, [on_frame, user_data] (const PitchResult& result)
+    {
+        if (on_frame != nullptr)
+        {
+            const auto frameResult = toCResult(result);
+            on_frame(&frameResult, user_data);
+        }
+    });
+}
+
+void bassbud_tracker_get_result(const bassbud_tracker* tracker, bassbud_result* result)
+{
+    *result = toCResult(tracker->tracker.getResult());
+}
+
+double bassbud_tracker_get_analysis_sample_rate(const bassbud_tracker* tracker)
+{
+    return tracker->tracker.getAnalysisSampleRate();
+}
+
+}
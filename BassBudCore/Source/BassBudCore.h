@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * C interface to the BassBud detection pipeline (PitchTracker), for hosts that cannot use the
+ * C++ headers directly. C++ hosts can include ../../Default/Source/PitchTracker.h instead; neither
+ * depends on JUCE.
+ *
+ * A tracker is not thread-safe: create, process and destroy it from one thread at a time.
+ * bassbud_tracker_process() is real-time safe; create and destroy are not.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct bassbud_tracker bassbud_tracker;
+
+/** Mirrors PitchResult. */
+typedef struct bassbud_result
+{
+    float pitch;              /* Smoothed pitch in Hz, or 0 when nothing is being played. */
+    int midi_note_number;     /* Nearest MIDI note, or -1. */
+    int string;               /* String index, lowest string first, or -1. */
+    int fret;                 /* Fret on that string, or -1. */
+    float confidence;         /* Detector confidence for the latest frame, 0..1. */
+    int provisional;          /* Non-zero while the note comes from the fast-attack window. */
+    float voiced_probability; /* How likely the confirmed frame is to be voiced, 0..1. */
+} bassbud_result;
+
+/** Called after every analysis frame with the updated result. */
+typedef void (*bassbud_frame_callback)(const bassbud_result* result, void* user_data);
+
+/**
+ * Creates a tracker for a standard-tuned 4-string bass. window_size and hop_size are in samples at
+ * the decimated analysis rate (see bassbud_tracker_get_analysis_sample_rate()).
+ * Returns NULL if the arguments are invalid or allocation fails.
+ */
+bassbud_tracker* bassbud_tracker_create(double sample_rate, int window_size, int hop_size);
+
+/**
+ * As bassbud_tracker_create(), for any instrument: open_string_notes holds num_strings MIDI notes,
+ * lowest string first (at most 6), and num_frets is at most 24.
+ */
+bassbud_tracker* bassbud_tracker_create_for_instrument(double sample_rate, int window_size, int hop_size,
+                                                        const int* open_string_notes, int num_strings, int num_frets);
+
+void bassbud_tracker_destroy(bassbud_tracker* tracker);
+
+/** Forgets the current note and all buffered audio. */
+void bassbud_tracker_reset(bassbud_tracker* tracker);
+
+/** Analyses a block of mono samples, calling on_frame (if not NULL) after every frame. */
+void bassbud_tracker_process(bassbud_tracker* tracker, const float* samples, int num_samples,
+                             bassbud_frame_callback on_frame, void* user_data);
+
+/** Copies the current result. */
+void bassbud_tracker_get_result(const bassbud_tracker* tracker, bassbud_result* result);
+
+double bassbud_tracker_get_analysis_sample_rate(const bassbud_tracker* tracker);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+#include "BassBudCore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Runs a few synthetic notes through the C interface and checks that each is recognised. Returns
+ * non-zero if any check fails, for CTest.
+ */
+namespace
+{
+    int numFailures = 0;
+
+    void check(bool condition, const char* description, int midiNoteNumber)
+    {
+        if (! condition)
+        {
+            std::printf("FAILED: %s (note %d)\n", description, midiNoteNumber);
+            ++numFailures;
+        }
+    }
+
+    double getNoteFrequency(int midiNoteNumber)
+    {
+        return 440.0 * std::pow(2.0, (midiNoteNumber - 69) / 12.0);
+    }
+
+    /** A plucked-string-like tone: decaying harmonics with 1/k amplitudes. */
+    std::vector<float> renderNote(int midiNoteNumber, double sampleRate, int numSamples)
+    {
+        const double twoPi = 6.283185307179586;
+        const double frequency = getNoteFrequency(midiNoteNumber);
+        std::vector<float> samples(static_cast<size_t>(numSamples), 0.0f);
+
+        for (int k = 1; k <= 8 && k * frequency < sampleRate * 0.5; ++k)
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double seconds = i / sampleRate;
+                samples[static_cast<size_t>(i)] += static_cast<float>(0.5 / k * std::exp(-k * seconds / 1.5)
+                                                                      * std::sin(twoPi * k * frequency * seconds));
+            }
+
+        return samples;
+    }
+
+    /** Counts the frames whose shown note was the expected one. */
+    struct FrameCounts
+    {
+        int expectedNote = -1;
+        int numFrames = 0;
+        int numMatching = 0;
+    };
+
+    void countFrame(const bassbud_result* result, void* userData)
+    {
+        auto& counts = *static_cast<FrameCounts*>(userData);
+        ++counts.numFrames;
+        if (result->midi_note_number == counts.expectedNote)
+            ++counts.numMatching;
+    }
+
+    /** Feeds samples to the tracker in host-sized blocks. */
+    void processInBlocks(bassbud_tracker* tracker, const std::vector<float>& samples, FrameCounts* counts)
+    {
+        const int blockSize = 480;
+        for (size_t start = 0; start < samples.size(); start += blockSize)
+        {
+            const int numSamples = static_cast<int>(std::min(samples.size() - start, static_cast<size_t>(blockSize)));
+            bassbud_tracker_process(tracker, samples.data() + start, numSamples, counts != nullptr ? countFrame : nullptr, counts);
+        }
+    }
+}
+
+int main()
+{
+    const double sampleRate = 48000.0;
+    const int windowSize = 512;  // The plugin's defaults, in samples at the analysis rate.
+    const int hopSize = 64;
+
+    check(bassbud_tracker_create(sampleRate, windowSize, windowSize + 1) == nullptr, "hop longer than the window is rejected", -1);
+    check(bassbud_tracker_create(0.0, windowSize, hopSize) == nullptr, "zero sample rate is rejected", -1);
+
+    bassbud_tracker* tracker = bassbud_tracker_create(sampleRate, windowSize, hopSize);
+    check(tracker != nullptr, "tracker is created", -1);
+    if (tracker == nullptr)
+        return 1;
+
+    check(bassbud_tracker_get_analysis_sample_rate(tracker) <= sampleRate, "analysis rate is at most the input rate", -1);
+
+    // Open E and A, a fretted note on the G string and one high up the neck
+    for (int note : { 28, 33, 45, 55 })
+    {
+        bassbud_tracker_reset(tracker);
+
+        FrameCounts counts;
+        counts.expectedNote = note;
+        processInBlocks(tracker, renderNote(note, sampleRate, static_cast<int>(sampleRate)), &counts);
+
+        bassbud_result result {};
+        bassbud_tracker_get_result(tracker, &result);
+
+        check(counts.numFrames > 0, "frames are reported", note);
+        check(counts.numMatching > counts.numFrames / 2, "most frames show the note", note);
+        check(result.midi_note_number == note, "the note is showing at the end", note);
+        check(std::abs(result.pitch / getNoteFrequency(note) - 1.0) < 0.01, "the pitch is within 1%", note);
+        check(result.string >= 0 && result.fret >= 0, "the note is placed on the neck", note);
+
+        // A second of silence clears it
+        processInBlocks(tracker, std::vector<float>(static_cast<size_t>(sampleRate), 0.0f), nullptr);
+        bassbud_tracker_get_result(tracker, &result);
+        check(result.midi_note_number == -1 && result.pitch == 0.0f, "silence clears the note", note);
+    }
+
+    bassbud_tracker_destroy(tracker);
+
+    if (numFailures == 0)
+        std::printf("All checks passed\n");
+
+    return numFailures == 0 ? 0 : 1;
+}
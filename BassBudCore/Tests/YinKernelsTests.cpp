@@ -0,0 +1,134 @@
+#include "YinKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Checks every kernel table the running CPU supports against the scalar reference, over lengths
+ * that leave every possible remainder after the vector loops and over buffers starting off the
+ * vector alignment. Returns non-zero if any result differs by more than float rounding, for CTest.
+ */
+namespace
+{
+    int numFailures = 0;
+
+    void check(bool condition, const char* kernel, const char* table, int length, int offset)
+    {
+        if (! condition)
+        {
+            std::printf("FAILED: %s (%s, length %d, offset %d)\n", kernel, table, length, offset);
+            ++numFailures;
+        }
+    }
+
+    bool isClose(float value, float reference, float tolerance)
+    {
+        return std::abs(value - reference) <= tolerance * std::max(1.0f, std::abs(reference));
+    }
+
+    /** Deterministic values in [low, high). */
+    std::vector<float> makeValues(size_t count, float low, float high, uint32_t seed)
+    {
+        std::vector<float> values(count);
+        for (auto& value : values)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            value = low + (high - low) * static_cast<float>(seed >> 8) / 16777216.0f;
+        }
+        return values;
+    }
+
+    const int maxOffset = 7;  // Floats past an aligned start: every misalignment for AVX2's 32 bytes.
+
+    std::vector<int> getLengths()
+    {
+        std::vector<int> lengths;
+        for (int n = 0; n <= 40; ++n)
+            lengths.push_back(n);
+        for (int n : { 63, 64, 65, 127, 255, 257, 511, 1023, 1025, 2049 })
+            lengths.push_back(n);
+        return lengths;
+    }
+
+    void testSquaredDifferenceSum(const YinKernels::KernelTable& table, const YinKernels::KernelTable& scalar)
+    {
+        const auto a = makeValues(4096, -1.0f, 1.0f, 1);
+        const auto b = makeValues(4096, -1.0f, 1.0f, 2);
+
+        for (int n : getLengths())
+            for (int offset = 0; offset <= maxOffset; ++offset)
+            {
+                // b is shifted by a different amount, as YIN compares a window with a lagged copy
+                const float* first = a.data() + offset;
+                const float* second = b.data() + (offset * 3 + 1) % (maxOffset + 1);
+                check(isClose(table.squaredDifferenceSum(first, second, n), scalar.squaredDifferenceSum(first, second, n), 1.0e-5f),
+                      "squaredDifferenceSum", table.name, n, offset);
+            }
+    }
+
+    void testPowerSpectrum(const YinKernels::KernelTable& table, const YinKernels::KernelTable& scalar)
+    {
+        const auto input = makeValues(4096 + 2 * maxOffset, -100.0f, 100.0f, 3);
+
+        for (int numBins : getLengths())
+            for (int offset = 0; offset <= maxOffset; ++offset)
+            {
+                auto vectorResult = input;
+                auto scalarResult = input;
+                table.powerSpectrum(vectorResult.data() + offset, numBins);
+                scalar.powerSpectrum(scalarResult.data() + offset, numBins);
+
+                bool matches = true;
+                for (size_t i = 0; i < input.size(); ++i)
+                    matches = matches && isClose(vectorResult[i], scalarResult[i], 1.0e-6f);
+                check(matches, "powerSpectrum", table.name, numBins, offset);
+            }
+    }
+
+    void testNormaliseCmnd(const YinKernels::KernelTable& table, const YinKernels::KernelTable& scalar)
+    {
+        const auto input = makeValues(4096, 0.0f, 4.0f, 4);
+        const auto runningSums = makeValues(4096, 0.5f, 50.0f, 5);
+
+        for (int length : getLengths())
+            for (int start = 1; start <= maxOffset + 1; ++start)  // tau starts at 1 in YinPitchDetector.
+            {
+                auto vectorResult = input;
+                auto scalarResult = input;
+                table.normaliseCmnd(vectorResult.data(), runningSums.data(), start, start + length);
+                scalar.normaliseCmnd(scalarResult.data(), runningSums.data(), start, start + length);
+
+                bool matches = true;
+                for (size_t i = 0; i < input.size(); ++i)
+                    matches = matches && isClose(vectorResult[i], scalarResult[i], 1.0e-6f);
+                check(matches, "normaliseCmnd", table.name, length, start);
+            }
+    }
+}
+
+int main()
+{
+    const auto& scalar = YinKernels::getScalarKernels();
+    const auto tables = YinKernels::getSupportedKernels();
+
+    check(std::find(tables.begin(), tables.end(), &YinKernels::getKernels()) != tables.end(),
+          "getKernels() is one of the supported tables", YinKernels::getKernels().name, 0, 0);
+
+    for (const auto* table : tables)
+    {
+        if (table == &scalar)
+            continue;
+
+        std::printf("Checking %s kernels\n", table->name);
+        testSquaredDifferenceSum(*table, scalar);
+        testPowerSpectrum(*table, scalar);
+        testNormaliseCmnd(*table, scalar);
+    }
+
+    if (numFailures == 0)
+        std::printf("All checks passed\n");
+
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,283 @@
+#include "BatchAnalysis.h"
+#include "../../Default/Source/PitchTracker.h"
+#include <atomic>
+
+namespace
+{
+    struct BatchOptions
+    {
+        juce::Array<juce::File> inputFiles;
+        juce::File outputDirectory;  // Empty: write each track next to its input file.
+        bool writeJson = false;
+        int numThreads = juce::SystemStats::getNumCpus();
+        int windowSize = 512;  // Same defaults as the plugin, in samples at the analysis rate.
+        int hopSize = 64;
+    };
+
+    /** One row of the output track. */
+    struct AnalysedFrame
+    {
+        double time;  // End of the analysis frame, in seconds.
+        float detectedPitch;  // Raw detector output before smoothing.
+        PitchResult result;  // Smoothed pitch and note state after this frame.
+    };
+
+    struct FileReport
+    {
+        juce::File file;
+        juce::String error;  // Empty on success.
+        double audioSeconds = 0.0;
+        double processingSeconds = 0.0;
+        size_t numFrames = 0;
+    };
+
+    const char* const audioFileWildcard = "*.wav;*.aif;*.aiff;*.flac";
+
+    juce::String midiNoteToName(int midiNoteNumber)
+    {
+        if (midiNoteNumber < 0)
+            return "---";
+
+        return juce::MidiMessage::getMidiNoteName(midiNoteNumber, true, true, 4);  // Same naming as the editor
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: BassBudTools analyse [options] <file or directory>...\n"
+                     "  --json              Write JSON instead of CSV\n"
+                     "  --out <directory>   Write tracks here instead of next to each input\n"
+                     "  --threads <n>       Number of files analysed in parallel (default: CPU count)\n"
+                     "  --window <samples>  Analysis window at the analysis rate (default: 512)\n"
+                     "  --hop <samples>     Analysis hop at the analysis rate (default: 64)\n";
+    }
+
+    /** Parses the command line; returns false (after printing why) if it is unusable. */
+    bool parseOptions(const juce::StringArray& args, BatchOptions& options)
+    {
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--json")
+                options.writeJson = true;
+            else if (arg == "--out" && hasValue)
+                options.outputDirectory = cwd.getChildFile(args[++i]);
+            else if (arg == "--threads" && hasValue)
+                options.numThreads = juce::jmax(1, args[++i].getIntValue());
+            else if (arg == "--window" && hasValue)
+                options.windowSize = args[++i].getIntValue();
+            else if (arg == "--hop" && hasValue)
+                options.hopSize = args[++i].getIntValue();
+            else if (arg.startsWith("--"))
+            {
+                std::cerr << "Unknown or incomplete option: " << arg << "\n";
+                return false;
+            }
+            else
+            {
+                const auto input = cwd.getChildFile(arg);
+
+                if (input.isDirectory())
+                    options.inputFiles.addArray(input.findChildFiles(juce::File::findFiles, true, audioFileWildcard));
+                else if (input.existsAsFile())
+                    options.inputFiles.add(input);
+                else
+                    std::cerr << "Skipping missing input: " << arg << "\n";
+            }
+        }
+
+        if (options.inputFiles.isEmpty())
+        {
+            printUsage();
+            return false;
+        }
+
+        if (options.outputDirectory != juce::File() && ! options.outputDirectory.createDirectory())
+        {
+            std::cerr << "Cannot create output directory " << options.outputDirectory.getFullPathName() << "\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    void writeCsv(juce::OutputStream& out, const std::vector<AnalysedFrame>& frames)
+    {
+        out << "time_s,detected_hz,pitch_hz,midi_note,note,string,fret,confidence,voiced_probability\n";
+
+        for (const auto& frame : frames)
+        {
+            out << juce::String(frame.time, 4) << ","
+                << juce::String(frame.detectedPitch, 3) << ","
+                << juce::String(frame.result.pitch, 3) << ","
+                << frame.result.midiNoteNumber << ","
+                << midiNoteToName(frame.result.midiNoteNumber) << ","
+                << frame.result.string << ","
+                << frame.result.fret << ","
+                << juce::String(frame.result.confidence, 3) << ","
+                << juce::String(frame.result.voicedProbability, 3) << "\n";
+        }
+    }
+
+    void writeJson(juce::OutputStream& out, const juce::File& input, double sampleRate,
+                   const PitchTracker& tracker, const std::vector<AnalysedFrame>& frames)
+    {
+        out << "{\n"
+            << "  \"file\": " << juce::JSON::toString(input.getFullPathName()) << ",\n"
+            << "  \"sampleRate\": " << sampleRate << ",\n"
+            << "  \"analysisSampleRate\": " << tracker.getAnalysisSampleRate() << ",\n"
+            << "  \"windowSize\": " << tracker.getWindowSize() << ",\n"
+            << "  \"hopSize\": " << tracker.getHopSize() << ",\n"
+            << "  \"frames\": [";
+
+        for (size_t i = 0; i < frames.size(); ++i)
+        {
+            const auto& frame = frames[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\"t\": " << juce::String(frame.time, 4)
+                << ", \"detected\": " << juce::String(frame.detectedPitch, 3)
+                << ", \"pitch\": " << juce::String(frame.result.pitch, 3)
+                << ", \"midi\": " << frame.result.midiNoteNumber
+                << ", \"note\": \"" << midiNoteToName(frame.result.midiNoteNumber) << "\""
+                << ", \"string\": " << frame.result.string
+                << ", \"fret\": " << frame.result.fret
+                << ", \"confidence\": " << juce::String(frame.result.confidence, 3)
+                << ", \"voiced\": " << juce::String(frame.result.voicedProbability, 3) << "}";
+        }
+
+        out << "\n  ]\n}\n";
+    }
+
+    /** Decodes and analyses one file and writes its track. Runs on a thread-pool thread. */
+    FileReport analyseFile(const juce::File& input, const BatchOptions& options)
+    {
+        FileReport report;
+        report.file = input;
+
+        juce::AudioFormatManager formatManager;  // One per job: readers are created concurrently.
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+        if (reader == nullptr || reader->numChannels == 0 || reader->sampleRate <= 0.0)
+        {
+            report.error = "unsupported or unreadable audio file";
+            return report;
+        }
+
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        PitchTracker tracker;
+        tracker.prepare(reader->sampleRate, options.windowSize, options.hopSize);
+
+        std::vector<AnalysedFrame> frames;
+        frames.reserve(static_cast<size_t>(reader->lengthInSamples / reader->sampleRate
+                                           * tracker.getAnalysisSampleRate() / tracker.getHopSize()) + 1);
+
+        // Like the plugin, only the first channel is analysed
+        const int blockSize = 8192;
+        juce::AudioBuffer<float> block(static_cast<int>(reader->numChannels), blockSize);
+
+        for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += blockSize)
+        {
+            const int numSamples = static_cast<int>(juce::jmin<juce::int64>(blockSize, reader->lengthInSamples - pos));
+            reader->read(&block, 0, numSamples, pos, true, true);
+
+            tracker.process(block.getReadPointer(0), numSamples, [&] (const PitchResult& result)
+            {
+                frames.push_back({ tracker.getFrameTimeSeconds(), tracker.getLastDetectedPitch(), result });
+            });
+        }
+
+        const auto outputDirectory = options.outputDirectory == juce::File() ? input.getParentDirectory()
+                                                                               : options.outputDirectory;
+        const auto outputFile = outputDirectory.getChildFile(input.getFileNameWithoutExtension()
+                                                             + (options.writeJson ? ".bassbud.json" : ".bassbud.csv"));
+
+        juce::FileOutputStream out(outputFile);
+        if (out.failedToOpen())
+        {
+            report.error = "cannot write " + outputFile.getFullPathName();
+            return report;
+        }
+
+        out.setPosition(0);
+        out.truncate();
+
+        if (options.writeJson)
+            writeJson(out, input, reader->sampleRate, tracker, frames);
+        else
+            writeCsv(out, frames);
+
+        report.audioSeconds = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+        report.processingSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        report.numFrames = frames.size();
+        return report;
+    }
+}
+
+int runBatchAnalysis(const juce::StringArray& args)
+{
+    BatchOptions options;
+    if (! parseOptions(args, options))
+        return 1;
+
+    const int numFiles = options.inputFiles.size();
+    std::vector<FileReport> reports(static_cast<size_t>(numFiles));
+
+    juce::CriticalSection outputLock;  // Serialises progress lines from the worker threads.
+    juce::WaitableEvent allDone;
+    std::atomic<int> remaining { numFiles };
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(juce::ThreadPoolOptions{}.withThreadName("BassBud batch")
+                                                       .withNumberOfThreads(juce::jmin(options.numThreads, numFiles)));
+
+        for (int i = 0; i < numFiles; ++i)
+        {
+            pool.addJob([&, i]
+            {
+                auto& report = reports[static_cast<size_t>(i)];
+                report = analyseFile(options.inputFiles.getReference(i), options);
+
+                {
+                    const juce::ScopedLock sl(outputLock);
+                    if (report.error.isNotEmpty())
+                        std::cerr << "FAILED " << report.file.getFullPathName() << ": " << report.error << "\n";
+                    else
+                        std::cout << report.file.getFileName() << ": " << report.numFrames << " frames, "
+                                  << juce::String(report.audioSeconds, 1) << " s audio, "
+                                  << juce::String(report.audioSeconds / juce::jmax(1.0e-9, report.processingSeconds), 1)
+                                  << "x realtime\n";
+                }
+
+                if (--remaining == 0)
+                    allDone.signal();
+            });
+        }
+
+        allDone.wait();
+    }
+
+    const double wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    double totalAudioSeconds = 0.0;
+    int numFailed = 0;
+
+    for (const auto& report : reports)
+    {
+        totalAudioSeconds += report.audioSeconds;
+        if (report.error.isNotEmpty())
+            ++numFailed;
+    }
+
+    std::cout << "\n" << (numFiles - numFailed) << "/" << numFiles << " files, "
+              << juce::String(totalAudioSeconds, 1) << " s audio in " << juce::String(wallSeconds, 2) << " s ("
+              << juce::String(totalAudioSeconds / juce::jmax(1.0e-9, wallSeconds), 1) << "x realtime on "
+              << juce::jmin(options.numThreads, numFiles) << " threads)\n";
+
+    return numFailed == 0 ? 0 : 1;
+}
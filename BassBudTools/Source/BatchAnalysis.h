@@ -0,0 +1,16 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <iostream>
+
+/**
+ * "analyse" command: runs the plugin's detection pipeline (PitchTracker) over audio files and
+ * writes a pitch/note track per file as CSV or JSON.
+ *
+ * Files are decoded with juce_audio_formats (WAV, AIFF, FLAC) and spread across a thread pool,
+ * one file per job. Throughput is reported as a realtime factor (seconds of audio analysed per
+ * second of wall-clock time), per file and for the whole batch.
+ *
+ * Returns the process exit code.
+ */
+int runBatchAnalysis(const juce::StringArray& args);
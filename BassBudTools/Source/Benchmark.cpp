@@ -0,0 +1,274 @@
+#include "Benchmark.h"
+#include "SyntheticBass.h"
+#include "../../Default/Source/YinPitchDetector.h"
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        juce::Array<int> windowSizes { 512, 1024, 2048, 4096, 8192 };
+        juce::Array<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+        juce::Array<YinPitchDetector::DifferenceMethod> methods { YinPitchDetector::DifferenceMethod::fft };
+        juce::Array<const YinKernels::KernelTable*> kernelTables { &YinKernels::getKernels() };
+        int iterations = 200;
+        bool writeJson = false;
+    };
+
+    /** Median and mean of one stage over all iterations, in nanoseconds per frame. */
+    struct StageStats
+    {
+        double median = 0.0;
+        double mean = 0.0;
+    };
+
+    StageStats summarise(std::vector<double> samples)
+    {
+        StageStats stats;
+        if (samples.empty())
+            return stats;
+
+        stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        auto middle = samples.begin() + static_cast<std::ptrdiff_t>(samples.size() / 2);
+        std::nth_element(samples.begin(), middle, samples.end());
+        stats.median = *middle;
+        return stats;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: BassBudTools bench [options]\n"
+                     "  --windows <a,b,...>  Window sizes in samples (default: 512,1024,2048,4096,8192)\n"
+                     "  --rates <a,b,...>    Sample rates in Hz (default: 44100,48000,88200,96000,176400,192000)\n"
+                     "  --method <m>         fft, reference, incremental or both (all three; default: fft)\n"
+                     "  --kernels <k>        best, scalar or both (default: best)\n"
+                     "  --iterations <n>     Frames measured per configuration (default: 200)\n"
+                     "  --json               Write JSON instead of CSV\n";
+    }
+
+    bool parseOptions(const juce::StringArray& args, BenchmarkOptions& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+            const juce::String value = hasValue ? args[i + 1] : juce::String();
+
+            if (arg == "--windows" && hasValue)
+            {
+                options.windowSizes.clear();
+                for (const auto& token : juce::StringArray::fromTokens(value, ",", {}))
+                    options.windowSizes.add(juce::jlimit(64, 65536, token.getIntValue()));
+            }
+            else if (arg == "--rates" && hasValue)
+            {
+                options.sampleRates.clear();
+                for (const auto& token : juce::StringArray::fromTokens(value, ",", {}))
+                    options.sampleRates.add(juce::jmax(8000.0, token.getDoubleValue()));
+            }
+            else if (arg == "--method" && hasValue)
+            {
+                options.methods.clear();
+                if (value == "fft" || value == "both")
+                    options.methods.add(YinPitchDetector::DifferenceMethod::fft);
+                if (value == "reference" || value == "both")
+                    options.methods.add(YinPitchDetector::DifferenceMethod::reference);
+                if (value == "incremental" || value == "both")
+                    options.methods.add(YinPitchDetector::DifferenceMethod::incremental);
+            }
+            else if (arg == "--kernels" && hasValue)
+            {
+                options.kernelTables.clear();
+                if (value == "best" || value == "both")
+                    options.kernelTables.add(&YinKernels::getKernels());
+                if (value == "scalar" || value == "both")
+                    options.kernelTables.addIfNotAlreadyThere(&YinKernels::getScalarKernels());
+            }
+            else if (arg == "--iterations" && hasValue)
+                options.iterations = juce::jmax(1, value.getIntValue());
+            else if (arg == "--json")
+            {
+                options.writeJson = true;
+                continue;
+            }
+            else
+            {
+                std::cerr << "Unknown or incomplete option: " << arg << "\n";
+                printUsage();
+                return false;
+            }
+
+            ++i;  // Skip the option's value.
+        }
+
+        if (options.windowSizes.isEmpty() || options.sampleRates.isEmpty()
+             || options.methods.isEmpty() || options.kernelTables.isEmpty())
+        {
+            printUsage();
+            return false;
+        }
+
+        return true;
+    }
+}
+
+/**
+ * Times the detector's individual steps. A friend of YinPitchDetector, so the steps can be run
+ * one at a time exactly as detectPitchPrefiltered() runs them.
+ */
+class YinStageBenchmark
+{
+public:
+    struct Result
+    {
+        StageStats prefilter, difference, cmnd, threshold, interpolation, detectPitch;
+    };
+
+    static Result run(YinPitchDetector& detector, const std::vector<float>& signal, int hopSize, int iterations)
+    {
+        const int windowSize = detector.bufferSize;
+        const int numOffsets = juce::jmax(1, (static_cast<int>(signal.size()) - windowSize) / hopSize);
+        std::vector<float> filtered(static_cast<size_t>(windowSize));
+        std::vector<double> prefilter, difference, cmnd, threshold, interpolation, detectPitch;
+        float sink = 0.0f;  // Keeps the optimiser from discarding the work being timed.
+
+        // Warm up caches and the FFT plan before measuring.
+        for (int i = 0; i < 10; ++i)
+            sink += detector.detectPitch(signal.data());
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const float* frame = signal.data() + (i % numOffsets) * hopSize;
+            detector.pendingFrameAdvance = i % numOffsets == 0 ? 0 : hopSize;  // Consecutive frames overlap, as in PitchTracker.
+
+            const auto t0 = juce::Time::getHighResolutionTicks();
+            detector.prefilter(frame, filtered.data(), windowSize);
+            const auto t1 = juce::Time::getHighResolutionTicks();
+            detector.difference(filtered.data());
+            const auto t2 = juce::Time::getHighResolutionTicks();
+            detector.cmndEnd = 0;
+            detector.cumulativeMeanNormalizedDifference(detector.lagLimit);  // The whole curve, as pYIN tracking needs.
+            const auto t3 = juce::Time::getHighResolutionTicks();
+            const int tau = detector.absoluteThreshold();
+            const auto t4 = juce::Time::getHighResolutionTicks();
+            if (tau != -1)
+                sink += detector.parabolicInterpolation(tau);
+            const auto t5 = juce::Time::getHighResolutionTicks();
+
+            prefilter.push_back(toNanoseconds(t1 - t0));
+            difference.push_back(toNanoseconds(t2 - t1));
+            cmnd.push_back(toNanoseconds(t3 - t2));
+            threshold.push_back(toNanoseconds(t4 - t3));
+            if (tau != -1)
+                interpolation.push_back(toNanoseconds(t5 - t4));
+        }
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const float* frame = signal.data() + (i % numOffsets) * hopSize;
+            const int advance = i % numOffsets == 0 ? 0 : hopSize;
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            detector.prefilter(frame, filtered.data(), windowSize);
+            sink += detector.detectPitchPrefiltered(filtered.data(), advance);
+            detectPitch.push_back(toNanoseconds(juce::Time::getHighResolutionTicks() - start));
+        }
+
+        juce::ignoreUnused(sink);
+        return { summarise(prefilter), summarise(difference), summarise(cmnd),
+                 summarise(threshold), summarise(interpolation), summarise(detectPitch) };
+    }
+
+private:
+    static double toNanoseconds(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9;
+    }
+};
+
+int runBenchmark(const juce::StringArray& args)
+{
+    BenchmarkOptions options;
+    if (! parseOptions(args, options))
+        return 1;
+
+    const char* const stageNames[] = { "prefilter", "difference", "cmnd", "threshold", "interpolation", "detect_pitch" };
+
+    if (options.writeJson)
+        std::cout << "[";
+    else
+    {
+        std::cout << "isa,method,sample_rate,window,iterations";
+        for (auto* stage : stageNames)
+            std::cout << "," << stage << "_ns_median," << stage << "_ns_mean";
+        std::cout << "\n";
+    }
+
+    bool first = true;
+
+    for (auto* kernels : options.kernelTables)
+    {
+        for (auto method : options.methods)
+        {
+            for (auto sampleRate : options.sampleRates)
+            {
+                // Two seconds of the four open strings, so frames cover both long and short periods.
+                std::vector<float> signal(static_cast<size_t>(sampleRate * 2.0), 0.0f);
+                juce::Random random(1234);
+                const int noteLength = static_cast<int>(signal.size() / 4);
+                const float openStrings[] = { 41.2f, 55.0f, 73.42f, 98.0f };
+
+                for (int n = 0; n < 4; ++n)
+                {
+                    PluckSettings pluck;
+                    pluck.frequency = openStrings[n];
+                    pluck.inharmonicity = 2.0e-4f;
+                    pluck.noiseLevel = 0.001f;
+                    renderPluck(signal.data() + n * noteLength, noteLength, sampleRate, pluck, random);
+                }
+
+                for (int windowSize : options.windowSizes)
+                {
+                    if (windowSize * 2 > static_cast<int>(signal.size()))
+                        continue;
+
+                    YinPitchDetector detector(static_cast<float>(sampleRate), windowSize);
+                    detector.setDifferenceMethod(method);
+                    detector.setKernels(*kernels);
+
+                    const auto result = YinStageBenchmark::run(detector, signal, juce::jmax(1, windowSize / 4), options.iterations);
+                    const StageStats* stages[] = { &result.prefilter, &result.difference, &result.cmnd,
+                                                   &result.threshold, &result.interpolation, &result.detectPitch };
+                    const char* methodName = method == YinPitchDetector::DifferenceMethod::fft ? "fft"
+                                              : method == YinPitchDetector::DifferenceMethod::reference ? "reference" : "incremental";
+
+                    if (options.writeJson)
+                    {
+                        std::cout << (first ? "\n" : ",\n") << "  {\"isa\": \"" << kernels->name << "\", \"method\": \"" << methodName
+                                  << "\", \"sampleRate\": " << sampleRate << ", \"window\": " << windowSize
+                                  << ", \"iterations\": " << options.iterations;
+                        for (int s = 0; s < 6; ++s)
+                            std::cout << ", \"" << stageNames[s] << "\": {\"medianNs\": " << juce::String(stages[s]->median, 1)
+                                      << ", \"meanNs\": " << juce::String(stages[s]->mean, 1) << "}";
+                        std::cout << "}";
+                    }
+                    else
+                    {
+                        std::cout << kernels->name << "," << methodName << "," << sampleRate << "," << windowSize << "," << options.iterations;
+                        for (auto* stage : stages)
+                            std::cout << "," << juce::String(stage->median, 1) << "," << juce::String(stage->mean, 1);
+                        std::cout << "\n";
+                    }
+
+                    first = false;
+                }
+            }
+        }
+    }
+
+    if (options.writeJson)
+        std::cout << "\n]\n";
+
+    return 0;
+}
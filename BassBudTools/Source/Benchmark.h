@@ -0,0 +1,16 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <iostream>
+
+/**
+ * "bench" command: microbenchmarks YinPitchDetector::detectPitch and each of its steps
+ * (prefilter, difference, cumulativeMeanNormalizedDifference, absoluteThreshold,
+ * parabolicInterpolation) on synthetic bass signals, sweeping window size and sample rate.
+ *
+ * Results are per-frame times in nanoseconds (median and mean over the measured iterations),
+ * one row per configuration, as CSV or JSON so runs from different commits can be diffed.
+ *
+ * Returns the process exit code.
+ */
+int runBenchmark(const juce::StringArray& args);
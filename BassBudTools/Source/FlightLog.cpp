@@ -0,0 +1,117 @@
+#include "FlightLog.h"
+#include "../../Default/Source/FlightRecorder.h"
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Usage: BassBudTools flightlog [options] <recording" << FlightRecorder::fileExtension << ">\n"
+                     "  --out <file>   Write the CSV here instead of to standard output\n";
+    }
+
+    juce::String midiNoteToName(int midiNoteNumber)
+    {
+        if (midiNoteNumber < 0)
+            return "---";
+        return juce::MidiMessage::getMidiNoteName(midiNoteNumber, true, true, 4);  // Same naming as the editor
+    }
+
+    void writeCsv(juce::OutputStream& out, const FlightRecorder::Recording& recording)
+    {
+        out << "channel,input_string,time_s,raw_hz,tracked_hz,pitch_hz,midi_note,note,string,fret,stable_frames,"
+               "cmnd_min,confidence,voiced_probability,provisional,gate_open,tracking,block_size,block_us,block_load\n";
+
+        for (const auto& channel : recording.channels)
+        {
+            for (const auto& entry : channel.entries)
+            {
+                // How much of its buffer period the block before the frame took
+                const double blockLoad = entry.blockSize > 0 && recording.sampleRate > 0.0
+                                           ? entry.blockMicroseconds * 1.0e-6 * recording.sampleRate / entry.blockSize
+                                           : 0.0;
+
+                out << channel.index << ","
+                    << channel.stringIndex << ","
+                    << juce::String(static_cast<double>(entry.frameSample) / recording.sampleRate, 4) << ","
+                    << juce::String(entry.rawPitch, 3) << ","
+                    << juce::String(entry.trackedPitch, 3) << ","
+                    << juce::String(entry.publishedPitch, 3) << ","
+                    << entry.midiNoteNumber << ","
+                    << midiNoteToName(entry.midiNoteNumber) << ","
+                    << entry.string << ","
+                    << entry.fret << ","
+                    << entry.stableFrameCount << ","
+                    << juce::String(entry.cmndMinimum, 4) << ","
+                    << juce::String(entry.confidence, 3) << ","
+                    << juce::String(entry.voicedProbability, 3) << ","
+                    << ((entry.flags & FlightRecorder::provisional) != 0 ? 1 : 0) << ","
+                    << ((entry.flags & FlightRecorder::gateOpen) != 0 ? 1 : 0) << ","
+                    << ((entry.flags & FlightRecorder::probabilistic) != 0 ? "pyin" : "stability") << ","
+                    << entry.blockSize << ","
+                    << juce::String(entry.blockMicroseconds, 1) << ","
+                    << juce::String(blockLoad, 3) << "\n";
+            }
+        }
+    }
+}
+
+int runFlightLog(const juce::StringArray& args)
+{
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    juce::File input, output;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--out" && i + 1 < args.size())
+            output = cwd.getChildFile(args[++i]);
+        else if (args[i].startsWith("--") || input != juce::File())
+        {
+            std::cerr << "Unknown or incomplete option: " << args[i] << "\n";
+            printUsage();
+            return 1;
+        }
+        else
+            input = cwd.getChildFile(args[i]);
+    }
+
+    if (input == juce::File())
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::FileInputStream in(input);
+    FlightRecorder::Recording recording;
+    if (in.failedToOpen() || ! FlightRecorder::read(in, recording) || recording.sampleRate <= 0.0)
+    {
+        std::cerr << "Not a readable flight recording: " << input.getFullPathName() << "\n";
+        return 1;
+    }
+
+    // Settings go to stderr, so standard output stays plain CSV
+    size_t numFrames = 0;
+    for (const auto& channel : recording.channels)
+        numFrames += channel.entries.size();
+    std::cerr << recording.channels.size() << " channel(s), " << numFrames << " frames at " << recording.sampleRate << " Hz, analysis "
+              << recording.analysisSampleRate << " Hz, window " << recording.windowSize << ", hop " << recording.hopSize << "\n";
+
+    if (output == juce::File())
+    {
+        juce::MemoryOutputStream csv;
+        writeCsv(csv, recording);
+        std::cout << csv.toString();
+        return 0;
+    }
+
+    juce::FileOutputStream out(output);
+    if (out.failedToOpen())
+    {
+        std::cerr << "Cannot write " << output.getFullPathName() << "\n";
+        return 1;
+    }
+
+    out.setPosition(0);
+    out.truncate();
+    writeCsv(out, recording);
+    return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <iostream>
+
+/**
+ * "flightlog" command: decodes a flight recording saved from the plugin (FlightRecorder, the
+ * editor's Save Log button) into one CSV row per analysis frame and channel, so the frames around
+ * a wrong note can be read or plotted.
+ *
+ * Returns the process exit code.
+ */
+int runFlightLog(const juce::StringArray& args);
@@ -0,0 +1,50 @@
+#include <JuceHeader.h>
+#include "BatchAnalysis.h"
+#include "Benchmark.h"
+#include "Regression.h"
+#include "FlightLog.h"
+
+/**
+ * Command-line tools built on the plugin's detection code, for working without a DAW.
+ * The first argument selects the command; the rest are passed on to it.
+ */
+static void printUsage()
+{
+    std::cout << "Usage: BassBudTools <command> [options]\n"
+                 "Commands:\n"
+                 "  analyse   Write pitch/note tracks for audio files (CSV or JSON)\n"
+                 "  bench     Time the pitch detector and its steps on synthetic signals\n"
+                 "  regress   Check accuracy and note latency on a synthetic bass corpus\n"
+                 "  flightlog Decode a flight recording saved from the plugin to CSV\n";
+}
+
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::CharPointer_UTF8(argv[i]));
+
+    if (args.isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto command = args[0];
+    args.remove(0);
+
+    if (command == "analyse" || command == "analyze")
+        return runBatchAnalysis(args);
+
+    if (command == "bench")
+        return runBenchmark(args);
+
+    if (command == "regress")
+        return runRegression(args);
+
+    if (command == "flightlog")
+        return runFlightLog(args);
+
+    printUsage();
+    return 1;
+}
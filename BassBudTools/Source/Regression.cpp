@@ -0,0 +1,424 @@
+#include "Regression.h"
+#include "SyntheticBass.h"
+#include "../../Default/Source/PitchTracker.h"
+#include <algorithm>
+
+namespace
+{
+    struct RegressionOptions
+    {
+        juce::Array<double> sampleRates { 44100.0, 48000.0, 96000.0 };
+        juce::Array<int> blockSizes { 32, 64, 100, 256, 512, 1024 };
+        int windowSize = 512;  // Same defaults as the plugin, in samples at the analysis rate.
+        int hopSize = 64;
+        PitchTracker::NoteTracking noteTracking = PitchTracker::NoteTracking::probabilistic;
+        double maxGrossErrorPercent = 5.0;
+        double maxLatencyMs = 175.0;
+    };
+
+    /** One note of a corpus case. Times are in seconds from the start of the case. */
+    struct CorpusNote
+    {
+        double start;
+        double length;
+        PluckSettings pluck;
+        bool dead = false;  // A muted, unpitched "dead note": the tracker should not report a note.
+    };
+
+    struct CorpusCase
+    {
+        juce::String name;
+        std::vector<CorpusNote> notes;
+        float noiseLevel = 0.0f;  // Continuous noise and DC over the whole case.
+        float dcOffset = 0.0f;
+    };
+
+    /** A stretch of a note with one known pitch, used as ground truth. */
+    struct Segment
+    {
+        double start;
+        double end;
+        float frequency;
+        int midiNoteNumber;
+    };
+
+    /** What the tracker reported after one frame. */
+    struct Frame
+    {
+        double time;  // End of the frame, in seconds.
+        float pitch;
+        int midiNoteNumber;
+        bool gated;  // The level gate was closed, so YIN did not run.
+        bool provisional;  // The note came from the fast-attack window.
+
+        bool operator==(const Frame& other) const
+        {
+            return time == other.time && pitch == other.pitch && midiNoteNumber == other.midiNoteNumber
+                   && gated == other.gated && provisional == other.provisional;
+        }
+    };
+
+    struct RunStats
+    {
+        int voicedFrames = 0;  // Frames whose whole window lies in a steady segment.
+        int reportedFrames = 0;  // ...of which the tracker reported a pitch.
+        int grossErrors = 0;  // ...of which the pitch was more than 50 cents out.
+        int octaveErrors = 0;  // ...of which the error was within a semitone of an octave.
+        int notes = 0;
+        int missedNotes = 0;  // Segments in which the correct note was never reported.
+        double totalLatencyMs = 0.0;  // Onset to the first frame showing the right note, provisional or not.
+        double maxLatencyMs = 0.0;
+        double totalConfirmedLatencyMs = 0.0;  // Onset to the first frame confirming the right note.
+        int confirmedNotes = 0;
+        int falseNoteFrames = 0;  // Frames reporting a note during a dead note.
+        int gatedFrames = 0;
+        int totalFrames = 0;
+
+        double grossErrorPercent() const { return reportedFrames > 0 ? 100.0 * grossErrors / reportedFrames : 0.0; }
+        double gatedPercent() const { return totalFrames > 0 ? 100.0 * gatedFrames / totalFrames : 0.0; }
+        double meanLatencyMs() const { return notes > missedNotes ? totalLatencyMs / (notes - missedNotes) : 0.0; }
+        double meanConfirmedLatencyMs() const { return confirmedNotes > 0 ? totalConfirmedLatencyMs / confirmedNotes : 0.0; }
+    };
+
+    PluckSettings makePluck(float frequency, float inharmonicity = 3.0e-4f)
+    {
+        PluckSettings pluck;
+        pluck.frequency = frequency;
+        pluck.inharmonicity = inharmonicity;
+        return pluck;
+    }
+
+    float midiNoteToFrequency(int midiNoteNumber)
+    {
+        return 440.0f * std::pow(2.0f, (midiNoteNumber - 69) / 12.0f);
+    }
+
+    /** The fixed corpus. Changing it changes every reported number, so extend it rather than edit it. */
+    std::vector<CorpusCase> makeCorpus()
+    {
+        std::vector<CorpusCase> corpus;
+
+        {
+            CorpusCase openStrings { "open strings", {} };
+            double time = 0.1;
+            for (float frequency : { 41.20f, 55.00f, 73.42f, 98.00f })
+            {
+                openStrings.notes.push_back({ time, 1.0, makePluck(frequency) });
+                time += 1.25;
+            }
+            corpus.push_back(openStrings);
+        }
+
+        {
+            // Across the neck, from low E up to the top of the tracked range.
+            CorpusCase fretted { "fretted notes", {} };
+            double time = 0.1;
+            for (int midiNoteNumber : { 28, 31, 35, 38, 40, 43, 47, 50, 52, 55, 59, 62, 64, 67 })
+            {
+                fretted.notes.push_back({ time, 0.6, makePluck(midiNoteToFrequency(midiNoteNumber), 5.0e-4f) });
+                time += 0.75;
+            }
+            corpus.push_back(fretted);
+        }
+
+        {
+            CorpusCase noisy { "noise and DC", {}, 0.02f, 0.1f };
+            double time = 0.1;
+            for (float frequency : { 55.00f, 73.42f, 98.00f })
+            {
+                noisy.notes.push_back({ time, 1.0, makePluck(frequency) });
+                time += 1.25;
+            }
+            corpus.push_back(noisy);
+        }
+
+        {
+            // A up to D on the A string, then G down to E on the D string.
+            CorpusCase slides { "slides", {} };
+            auto up = makePluck(55.00f);
+            up.slideToFrequency = 73.42f;
+            up.slideStartSeconds = 0.4f;
+            up.slideSeconds = 0.3f;
+            slides.notes.push_back({ 0.1, 1.6, up });
+
+            auto down = makePluck(98.00f);
+            down.slideToFrequency = 82.41f;
+            down.slideStartSeconds = 0.4f;
+            down.slideSeconds = 0.15f;
+            slides.notes.push_back({ 2.0, 1.6, down });
+            corpus.push_back(slides);
+        }
+
+        {
+            // Muted plucks: a short thump and pick noise with no sustained pitch, then a real note.
+            CorpusCase deadNotes { "dead notes", {} };
+            double time = 0.1;
+            for (float frequency : { 41.20f, 55.00f, 73.42f })
+            {
+                auto dead = makePluck(frequency);
+                dead.decaySeconds = 0.02f;
+                dead.attackNoise = 0.4f;
+                deadNotes.notes.push_back({ time, 0.3, dead, true });
+                time += 0.6;
+            }
+            deadNotes.notes.push_back({ time, 1.0, makePluck(41.20f) });
+            corpus.push_back(deadNotes);
+        }
+
+        return corpus;
+    }
+
+    std::vector<float> renderCase(const CorpusCase& corpusCase, double sampleRate)
+    {
+        double length = 0.0;
+        for (const auto& note : corpusCase.notes)
+            length = juce::jmax(length, note.start + note.length);
+
+        std::vector<float> signal(static_cast<size_t>((length + 0.5) * sampleRate), 0.0f);
+        juce::Random random(42);
+
+        for (const auto& note : corpusCase.notes)
+        {
+            const auto start = static_cast<size_t>(note.start * sampleRate);
+            const int numSamples = juce::jmin(static_cast<int>(note.length * sampleRate), static_cast<int>(signal.size() - start));
+            renderPluck(signal.data() + start, numSamples, sampleRate, note.pluck, random);
+        }
+
+        for (auto& sample : signal)
+            sample += corpusCase.dcOffset + corpusCase.noiseLevel * (random.nextFloat() * 2.0f - 1.0f);
+
+        return signal;
+    }
+
+    /** Steady-pitch segments of the case; a slide splits its note into the parts before and after it. */
+    std::vector<Segment> getSegments(const CorpusCase& corpusCase)
+    {
+        std::vector<Segment> segments;
+
+        for (const auto& note : corpusCase.notes)
+        {
+            if (note.dead)
+                continue;
+
+            const double end = note.start + note.length;
+            const auto& pluck = note.pluck;
+
+            if (pluck.slideToFrequency > 0.0f)
+            {
+                segments.push_back({ note.start, note.start + pluck.slideStartSeconds, pluck.frequency,
+                                     PitchTracker::frequencyToMidiNote(pluck.frequency) });
+                segments.push_back({ note.start + pluck.slideStartSeconds + pluck.slideSeconds, end, pluck.slideToFrequency,
+                                     PitchTracker::frequencyToMidiNote(pluck.slideToFrequency) });
+            }
+            else
+            {
+                segments.push_back({ note.start, end, pluck.frequency, PitchTracker::frequencyToMidiNote(pluck.frequency) });
+            }
+        }
+
+        return segments;
+    }
+
+    /** Streams the signal through a tracker block by block, as DefaultAudioProcessor::processBlock() does. */
+    std::vector<Frame> track(const std::vector<float>& signal, double sampleRate, int blockSize, const RegressionOptions& options)
+    {
+        PitchTracker tracker;
+        tracker.prepare(sampleRate, options.windowSize, options.hopSize);
+        tracker.setNoteTracking(options.noteTracking);
+
+        std::vector<Frame> frames;
+        for (size_t pos = 0; pos < signal.size(); pos += static_cast<size_t>(blockSize))
+        {
+            const int numSamples = static_cast<int>(std::min(signal.size() - pos, static_cast<size_t>(blockSize)));
+            tracker.process(signal.data() + pos, numSamples, [&](const PitchResult& result)
+            {
+                frames.push_back({ tracker.getFrameTimeSeconds(), result.pitch, result.midiNoteNumber, ! tracker.isGateOpen(), result.provisional });
+            });
+        }
+
+        return frames;
+    }
+
+    RunStats evaluate(const CorpusCase& corpusCase, const std::vector<Frame>& frames, double windowSeconds)
+    {
+        RunStats stats;
+        const auto segments = getSegments(corpusCase);
+
+        for (const auto& segment : segments)
+        {
+            ++stats.notes;
+            bool found = false;
+            bool confirmed = false;
+
+            for (const auto& frame : frames)
+            {
+                if (frame.time < segment.start || frame.time > segment.end)
+                    continue;
+
+                if (! found && frame.midiNoteNumber == segment.midiNoteNumber)
+                {
+                    const double latencyMs = (frame.time - segment.start) * 1000.0;
+                    stats.totalLatencyMs += latencyMs;
+                    stats.maxLatencyMs = juce::jmax(stats.maxLatencyMs, latencyMs);
+                    found = true;
+                }
+
+                if (! confirmed && ! frame.provisional && frame.midiNoteNumber == segment.midiNoteNumber)
+                {
+                    stats.totalConfirmedLatencyMs += (frame.time - segment.start) * 1000.0;
+                    ++stats.confirmedNotes;
+                    confirmed = true;
+                }
+
+                // Only frames that saw nothing but this segment have a single right answer.
+                if (frame.time - windowSeconds < segment.start)
+                    continue;
+
+                ++stats.voicedFrames;
+                if (frame.pitch <= 0.0f)
+                    continue;
+
+                ++stats.reportedFrames;
+                const double cents = 1200.0 * std::log2(frame.pitch / segment.frequency);
+                if (std::abs(cents) > 50.0)
+                {
+                    ++stats.grossErrors;
+                    if (std::abs(std::abs(cents) - 1200.0) < 100.0)
+                        ++stats.octaveErrors;
+                }
+            }
+
+            if (! found)
+                ++stats.missedNotes;
+        }
+
+        for (const auto& frame : frames)
+        {
+            ++stats.totalFrames;
+            if (frame.gated)
+                ++stats.gatedFrames;
+        }
+
+        for (const auto& note : corpusCase.notes)
+        {
+            if (! note.dead)
+                continue;
+
+            for (const auto& frame : frames)
+                if (frame.time >= note.start && frame.time <= note.start + note.length && frame.midiNoteNumber >= 0)
+                    ++stats.falseNoteFrames;
+        }
+
+        return stats;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: BassBudTools regress [options]\n"
+                     "  --rates <a,b,...>         Sample rates in Hz (default: 44100,48000,96000)\n"
+                     "  --blocks <a,b,...>        Host block sizes (default: 32,64,100,256,512,1024)\n"
+                     "  --window <samples>        Analysis window at the analysis rate (default: 512)\n"
+                     "  --hop <samples>           Analysis hop at the analysis rate (default: 64)\n"
+                     "  --tracking <method>       Note tracking: pyin or stability (default: pyin)\n"
+                     "  --max-gross-error <pct>   Fail above this gross error rate (default: 5)\n"
+                     "  --max-latency <ms>        Fail above this worst-case note latency (default: 175)\n";
+    }
+
+    bool parseOptions(const juce::StringArray& args, RegressionOptions& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--rates" && hasValue)
+            {
+                options.sampleRates.clear();
+                for (const auto& token : juce::StringArray::fromTokens(args[++i], ",", {}))
+                    options.sampleRates.add(juce::jmax(8000.0, token.getDoubleValue()));
+            }
+            else if (arg == "--blocks" && hasValue)
+            {
+                options.blockSizes.clear();
+                for (const auto& token : juce::StringArray::fromTokens(args[++i], ",", {}))
+                    options.blockSizes.add(juce::jmax(1, token.getIntValue()));
+            }
+            else if (arg == "--window" && hasValue)
+                options.windowSize = args[++i].getIntValue();
+            else if (arg == "--hop" && hasValue)
+                options.hopSize = args[++i].getIntValue();
+            else if (arg == "--tracking" && hasValue && (args[i + 1] == "pyin" || args[i + 1] == "stability"))
+                options.noteTracking = args[++i] == "pyin" ? PitchTracker::NoteTracking::probabilistic
+                                                            : PitchTracker::NoteTracking::stabilityGate;
+            else if (arg == "--max-gross-error" && hasValue)
+                options.maxGrossErrorPercent = args[++i].getDoubleValue();
+            else if (arg == "--max-latency" && hasValue)
+                options.maxLatencyMs = args[++i].getDoubleValue();
+            else
+            {
+                std::cerr << "Unknown or incomplete option: " << arg << "\n";
+                printUsage();
+                return false;
+            }
+        }
+
+        if (options.sampleRates.isEmpty() || options.blockSizes.isEmpty())
+        {
+            printUsage();
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int runRegression(const juce::StringArray& args)
+{
+    RegressionOptions options;
+    if (! parseOptions(args, options))
+        return 1;
+
+    const auto corpus = makeCorpus();
+    bool passed = true;
+
+    std::cout << "case,sample_rate,voiced_frames,gross_error_pct,octave_errors,missed_notes,"
+                 "mean_latency_ms,max_latency_ms,mean_confirmed_latency_ms,false_note_frames,gated_frames_pct,block_sizes_match,result\n";
+
+    for (const auto& corpusCase : corpus)
+    {
+        for (auto sampleRate : options.sampleRates)
+        {
+            const auto signal = renderCase(corpusCase, sampleRate);
+
+            // The tracker's output must not depend on how the host splits the audio into blocks,
+            // so every block size has to reproduce the first one's frames exactly.
+            const auto frames = track(signal, sampleRate, options.blockSizes[0], options);
+            bool blockSizesMatch = true;
+            for (int b = 1; b < options.blockSizes.size(); ++b)
+                blockSizesMatch = blockSizesMatch && track(signal, sampleRate, options.blockSizes[b], options) == frames;
+
+            PitchTracker reference;
+            reference.prepare(sampleRate, options.windowSize, options.hopSize);
+            const double windowSeconds = reference.getWindowSize() / reference.getAnalysisSampleRate();
+            const auto stats = evaluate(corpusCase, frames, windowSeconds);
+
+            const bool ok = blockSizesMatch
+                             && stats.missedNotes == 0
+                             && stats.falseNoteFrames == 0
+                             && stats.grossErrorPercent() <= options.maxGrossErrorPercent
+                             && stats.maxLatencyMs <= options.maxLatencyMs;
+            passed = passed && ok;
+
+            std::cout << corpusCase.name << "," << sampleRate << "," << stats.voicedFrames << ","
+                      << juce::String(stats.grossErrorPercent(), 2) << "," << stats.octaveErrors << ","
+                      << stats.missedNotes << "," << juce::String(stats.meanLatencyMs(), 1) << ","
+                      << juce::String(stats.maxLatencyMs, 1) << "," << juce::String(stats.meanConfirmedLatencyMs(), 1) << ","
+                      << stats.falseNoteFrames << ","
+                      << juce::String(stats.gatedPercent(), 1) << ","
+                      << (blockSizesMatch ? "yes" : "no") << "," << (ok ? "pass" : "FAIL") << "\n";
+        }
+    }
+
+    std::cout << (passed ? "All runs passed.\n" : "Some runs failed.\n");
+    return passed ? 0 : 1;
+}
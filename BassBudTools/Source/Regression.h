@@ -0,0 +1,17 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <iostream>
+
+/**
+ * "regress" command: accuracy and detection-latency regression check.
+ *
+ * Renders a fixed synthetic bass corpus (plucks with inharmonicity, slides, dead notes, noise and
+ * DC) and streams it through PitchTracker exactly as the plugin's processBlock() does, at several
+ * sample rates and host block sizes. For each run it reports gross pitch errors (> 50 cents),
+ * octave errors, missed notes and the time from each note onset to the first frame reporting the
+ * correct note, and it checks that every block size produces the same frames.
+ *
+ * Returns 0 when every run is within the limits, 1 otherwise, so it can gate a change.
+ */
+int runRegression(const juce::StringArray& args);
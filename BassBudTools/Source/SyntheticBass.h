@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+/**
+ * Deterministic bass-like test signals for the benchmark and accuracy tools.
+ *
+ * A pluck is an additive plucked-string model: harmonics with 1/k amplitudes, stiff-string
+ * inharmonicity (partial k sits at k * f0 * sqrt(1 + B * k^2)), upper partials decaying faster
+ * than the fundamental, and a short noise burst for the pick attack. The fundamental can glide to
+ * another pitch part-way through (a slide), and noise and DC offset can be added on top. All
+ * randomness comes from the caller's juce::Random, so a fixed seed always produces the same signal.
+ */
+struct PluckSettings
+{
+    float frequency = 41.2f;  // Fundamental in Hz.
+    float amplitude = 0.5f;
+    float inharmonicity = 0.0f;  // B coefficient; roughly 1e-4 to 1e-3 for bass strings.
+    float decaySeconds = 2.0f;  // Time constant of the fundamental.
+    int numHarmonics = 12;
+    float attackNoise = 0.05f;  // Level of the pick noise burst.
+    float noiseLevel = 0.0f;  // Level of continuous white noise.
+    float dcOffset = 0.0f;
+
+    float slideToFrequency = 0.0f;  // Target of a slide in Hz, or 0 for a steady note.
+    float slideStartSeconds = 0.0f;  // When the slide starts, relative to the pluck.
+    float slideSeconds = 0.0f;  // How long the slide takes; the pitch moves evenly in cents.
+
+    /** The fundamental at the given time into the pluck. */
+    double getFrequencyAt(double seconds) const
+    {
+        if (slideToFrequency <= 0.0f)
+            return frequency;
+
+        const double progress = slideSeconds > 0.0f ? juce::jlimit(0.0, 1.0, (seconds - slideStartSeconds) / slideSeconds)
+                                                    : (seconds >= slideStartSeconds ? 1.0 : 0.0);
+        return frequency * std::pow(static_cast<double>(slideToFrequency) / frequency, progress);
+    }
+};
+
+/** Adds (mixes) a pluck into output, starting at output[0]. */
+inline void renderPluck(float* output, int numSamples, double sampleRate, const PluckSettings& settings, juce::Random& random)
+{
+    const double twoPi = 2.0 * juce::MathConstants<double>::pi;
+    const double nyquist = sampleRate * 0.5;
+
+    const double highestFrequency = juce::jmax(static_cast<double>(settings.frequency), static_cast<double>(settings.slideToFrequency));
+
+    for (int k = 1; k <= settings.numHarmonics; ++k)
+    {
+        const double stretch = k * std::sqrt(1.0 + settings.inharmonicity * k * k);  // Partial frequency / fundamental.
+        if (stretch * highestFrequency >= nyquist)
+            break;
+
+        const double decayPerSample = std::exp(-static_cast<double>(k) / (settings.decaySeconds * sampleRate));
+        double phase = random.nextDouble() * twoPi;
+        double gain = settings.amplitude / k;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            output[i] += static_cast<float>(gain * std::sin(phase));
+            phase += twoPi * stretch * settings.getFrequencyAt(i / sampleRate) / sampleRate;
+            gain *= decayPerSample;
+        }
+    }
+
+    // Pick attack: a few milliseconds of decaying noise.
+    const int attackLength = juce::jmin(numSamples, static_cast<int>(sampleRate * 0.005));
+    for (int i = 0; i < attackLength; ++i)
+        output[i] += settings.attackNoise * (1.0f - static_cast<float>(i) / attackLength) * (random.nextFloat() * 2.0f - 1.0f);
+
+    for (int i = 0; i < numSamples; ++i)
+        output[i] += settings.dcOffset + settings.noiseLevel * (random.nextFloat() * 2.0f - 1.0f);
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cmath>
+
+/**
+ * Anti-aliased decimation front-end for the pitch detector.
+ *
+ * Bass fundamentals stop around 400 Hz, so analysing at the host rate only makes every lag loop
+ * longer. This cascades half-band FIR stages, each halving the rate, until the next halving would
+ * drop below the requested minimum analysis rate. 44.1/48 kHz therefore end up at 5.5/6 kHz, and
+ * 96/192 kHz land at the same 6 kHz, so detector cost no longer grows with the session rate.
+ */
+class AnalysisDecimator
+{
+public:
+    /** Chooses the number of stages and clears all filter state. Not real-time safe. */
+    void prepare(double newInputSampleRate, double minOutputSampleRate)
+    {
+        inputSampleRate = newInputSampleRate;
+        factor = 1;
+        while (inputSampleRate / (factor * 2) >= minOutputSampleRate)
+            factor *= 2;
+
+        stages.assign(static_cast<size_t>(std::log2(factor) + 0.5), HalfBandStage());
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& stage : stages)
+            stage.reset();
+    }
+
+    int getFactor() const { return factor; }
+    double getOutputSampleRate() const { return inputSampleRate / factor; }
+
+    /** Group delay of the filter cascade, in input samples: each stage delays by its centre tap. */
+    int getLatencySamples() const { return HalfBandStage::centre * (factor - 1); }
+
+    /**
+     * Filters and decimates numSamples input samples, writing the output to output, which must have
+     * room for numSamples / getFactor() + 1 samples. Returns the number of samples written.
+     * State is kept between calls, so the input can be split into chunks of any size.
+     */
+    int process(const float* input, int numSamples, float* output)
+    {
+        int numOutput = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float sample = input[i];
+            bool produced = true;
+
+            // Each stage only emits every second sample, so most inputs stop early in the cascade.
+            for (auto& stage : stages)
+            {
+                if (! stage.process(sample))
+                {
+                    produced = false;
+                    break;
+                }
+            }
+
+            if (produced)
+                output[numOutput++] = sample;
+        }
+
+        return numOutput;
+    }
+
+private:
+    /**
+     * One 2:1 half-band FIR stage. Every other tap of a half-band filter is zero apart from the
+     * centre tap, so only the odd-offset taps are stored and evaluated, and only at the output rate.
+     */
+    class HalfBandStage
+    {
+    public:
+        HalfBandStage()
+        {
+            // Blackman-windowed sinc with cutoff at a quarter of the input rate, normalised for unity DC gain.
+            const double pi = 3.14159265358979323846;
+            double sum = 0.0;
+            for (int k = 0; k < numSideTaps; ++k)
+            {
+                const int offset = 2 * k + 1;
+                const double x = pi * offset / 2.0;
+                const double n = static_cast<double>(centre + offset) / (length - 1);
+                const double window = 0.42 - 0.5 * std::cos(2.0 * pi * n) + 0.08 * std::cos(4.0 * pi * n);
+                sideTaps[k] = 0.5 * std::sin(x) / x * window;
+                sum += 2.0 * sideTaps[k];
+            }
+
+            for (auto& tap : sideTaps)
+                tap *= 0.5 / sum;  // The centre tap supplies the other half of the DC gain.
+        }
+
+        void reset()
+        {
+            history.fill(0.0f);
+            writePos = 0;
+            emitNext = false;
+        }
+
+        /** Pushes one input sample; returns true and overwrites sample when an output is due. */
+        bool process(float& sample)
+        {
+            // Mirrored delay line, so the last `length` samples are always contiguous.
+            history[writePos] = sample;
+            history[writePos + length] = sample;
+            if (++writePos == length)
+                writePos = 0;
+
+            emitNext = ! emitNext;
+            if (! emitNext)
+                return false;
+
+            const float* window = history.data() + writePos;  // Oldest sample first.
+            double acc = 0.5 * window[centre];
+            for (int k = 0; k < numSideTaps; ++k)
+                acc += sideTaps[k] * (window[centre - 2 * k - 1] + window[centre + 2 * k + 1]);
+
+            sample = static_cast<float>(acc);
+            return true;
+        }
+
+        static constexpr int numSideTaps = 8;  // Non-zero taps on each side of the centre.
+        static constexpr int centre = 2 * numSideTaps - 1;
+        static constexpr int length = 2 * centre + 1;  // 31 taps.
+
+    private:
+
+        std::array<double, numSideTaps> sideTaps {};
+        std::array<float, 2 * length> history {};
+        int writePos = 0;
+        bool emitNext = false;  // Toggles every input; an output is produced on every second sample.
+    };
+
+    std::vector<HalfBandStage> stages;
+    double inputSampleRate = 44100.0;
+    int factor = 1;
+};
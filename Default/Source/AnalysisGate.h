@@ -0,0 +1,130 @@
+#pragma once
+#include <cmath>
+#include <algorithm>
+
+/**
+ * Level gate and onset detector that runs on the decimated analysis stream ahead of the detector.
+ *
+ * The gate follows a 10 ms mean-square envelope of the DC-blocked input. It opens above
+ * openThresholdDb and closes only after the envelope has stayed below closeThresholdDb for
+ * holdSeconds, so note tails are still tracked and the gate does not chatter around one level.
+ * While it is closed the pitch tracker skips YIN entirely.
+ *
+ * Onsets are reported when a 2 ms envelope jumps well above a 100 ms one: the pick attack of a new
+ * note. An onset also opens the gate immediately, and the tracker uses it to time its next frames
+ * to the new note rather than to the free-running hop grid.
+ *
+ * Works sample by sample with state kept between calls, so results do not depend on chunking.
+ */
+class AnalysisGate
+{
+public:
+    static constexpr float openThresholdDb = -60.0f;
+    static constexpr float closeThresholdDb = -66.0f;
+    static constexpr float holdSeconds = 0.1f;
+    static constexpr float onsetRatioDb = 9.0f;  // Fast envelope over slow envelope that counts as an attack.
+    static constexpr float onsetRefractorySeconds = 0.05f;  // No second onset within this time.
+
+    /** Sets the time constants for the analysis rate and closes the gate. */
+    void prepare(double sampleRate)
+    {
+        const auto coefficient = [sampleRate](double seconds) { return static_cast<float>(1.0 - std::exp(-1.0 / (seconds * sampleRate))); };
+
+        dcCoefficient = coefficient(1.0 / (2.0 * 3.14159265358979323846 * 20.0));  // 20 Hz DC blocker.
+        levelCoefficient = coefficient(0.01);
+        fastCoefficient = coefficient(0.002);
+        slowCoefficient = coefficient(0.1);
+        holdSamples = static_cast<int>(holdSeconds * sampleRate);
+        refractorySamples = static_cast<int>(onsetRefractorySeconds * sampleRate);
+        reset();
+    }
+
+    void reset()
+    {
+        dcEstimate = 0.0f;
+        level = fast = slow = 0.0f;
+        open = false;
+        samplesBelowClose = 0;
+        samplesSinceOnset = refractorySamples;
+        onsetPeak = 0.0f;
+    }
+
+    /**
+     * Feeds up to numSamples samples, stopping just after an onset if one occurs.
+     * Returns the number of samples consumed; check lastCallFoundOnset() to see why it stopped.
+     */
+    int process(const float* samples, int numSamples)
+    {
+        onsetFound = false;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            dcEstimate += dcCoefficient * (samples[i] - dcEstimate);
+            const float x = samples[i] - dcEstimate;
+            const float power = x * x;
+
+            level += levelCoefficient * (power - level);
+            fast += fastCoefficient * (power - fast);
+            slow += slowCoefficient * (power - slow);
+
+            if (level > openPower)
+                open = true;
+
+            // The hold counts one continuous stretch below the close threshold, not dips added up
+            if (level >= closePower)
+                samplesBelowClose = 0;
+            else if (open && ++samplesBelowClose >= holdSamples)
+                open = false;
+
+            if (samplesSinceOnset < refractorySamples)
+            {
+                ++samplesSinceOnset;
+                onsetPeak = std::max(onsetPeak, fast);  // The attack keeps rising for a few ms after it is detected
+            }
+            else if (fast > openPower && fast > onsetRatio * slow)
+            {
+                samplesSinceOnset = 0;
+                onsetPeak = fast;
+                onsetFound = true;
+                open = true;
+                samplesBelowClose = 0;
+                return i + 1;
+            }
+        }
+
+        return numSamples;
+    }
+
+    /** True while the input is loud enough to be worth analysing. */
+    bool isOpen() const { return open; }
+
+    /** True if the last call to process() stopped at an onset. */
+    bool lastCallFoundOnset() const { return onsetFound; }
+
+    /**
+     * Peak of the 2 ms envelope over the first onsetRefractorySeconds of the latest attack, in dB
+     * relative to full scale; how hard the note was played.
+     */
+    float getOnsetLevelDb() const { return 10.0f * std::log10(std::max(onsetPeak, 1.0e-12f)); }
+
+private:
+    static float dbToPower(float db) { return std::pow(10.0f, db / 10.0f); }
+
+    const float openPower = dbToPower(openThresholdDb);
+    const float closePower = dbToPower(closeThresholdDb);
+    const float onsetRatio = dbToPower(onsetRatioDb);
+
+    float dcCoefficient = 0.0f, levelCoefficient = 0.0f, fastCoefficient = 0.0f, slowCoefficient = 0.0f;
+    int holdSamples = 0;
+    int refractorySamples = 0;
+
+    float dcEstimate = 0.0f;  // Running mean removed before measuring level.
+    float level = 0.0f;  // 10 ms mean-square envelope used for the open/close decision.
+    float fast = 0.0f;  // 2 ms and 100 ms mean-square envelopes used for onset detection.
+    float slow = 0.0f;
+    bool open = false;
+    int samplesBelowClose = 0;
+    int samplesSinceOnset = 0;
+    bool onsetFound = false;
+    float onsetPeak = 0.0f;  // Largest fast envelope value since the latest onset.
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+
+/**
+ * Circular buffer that turns an arbitrarily chunked sample stream into overlapping analysis frames.
+ *
+ * A frame of windowSize samples becomes available every hopSize samples, counted from the start of
+ * the stream (or from the last alignFrames() call), so the frames produced do not depend on how
+ * the host splits audio into blocks.
+ * Every sample is stored twice (at pos and pos + windowSize), which keeps the most recent window
+ * contiguous in memory and lets it be handed to the detector without copying.
+ */
+class AnalysisRingBuffer
+{
+public:
+    /** Allocates storage and resets the stream. Not real-time safe; call from prepareToPlay. */
+    void prepare(int newWindowSize, int newHopSize)
+    {
+        windowSize = std::max(1, newWindowSize);
+        hopSize = std::clamp(newHopSize, 1, windowSize);
+        storage.assign(2 * static_cast<size_t>(windowSize), 0.0f);
+        reset();
+    }
+
+    /** Clears the buffered audio and restarts the hop counter. */
+    void reset()
+    {
+        std::fill(storage.begin(), storage.end(), 0.0f);
+        writePos = 0;
+        samplesUntilNextFrame = hopSize;
+        frameReady = false;
+    }
+
+    /** Number of samples that can be written before the next frame becomes ready. */
+    int getSamplesUntilNextFrame() const { return samplesUntilNextFrame; }
+
+    /**
+     * Writes up to numSamples samples, stopping early if a frame becomes ready.
+     * Returns the number of samples consumed; the caller should check isFrameReady() and then
+     * continue writing the remainder.
+     */
+    int write(const float* samples, int numSamples)
+    {
+        const int numToWrite = std::min(numSamples, samplesUntilNextFrame);
+
+        for (int i = 0; i < numToWrite; ++i)
+        {
+            storage[writePos] = samples[i];
+            storage[writePos + windowSize] = samples[i];  // Mirror copy keeps the window contiguous.
+            if (++writePos == windowSize)
+                writePos = 0;
+        }
+
+        samplesUntilNextFrame -= numToWrite;
+        if (samplesUntilNextFrame == 0)
+        {
+            frameReady = true;
+            samplesUntilNextFrame = hopSize;
+        }
+
+        return numToWrite;
+    }
+
+    /**
+     * Shifts the hop grid so that a frame boundary falls samplesFromNow samples from now (0 makes a
+     * frame ready immediately). The next frame therefore comes within one hop, and frames continue
+     * every hopSize samples from there.
+     */
+    void alignFrames(int samplesFromNow)
+    {
+        if (samplesFromNow <= 0)
+        {
+            frameReady = true;
+            samplesUntilNextFrame = hopSize;
+        }
+        else
+        {
+            samplesUntilNextFrame = (samplesFromNow - 1) % hopSize + 1;
+        }
+    }
+
+    bool isFrameReady() const { return frameReady; }
+
+    /** Returns the most recent windowSize samples, oldest first, and clears the ready flag. */
+    const float* getFrame()
+    {
+        frameReady = false;
+        return storage.data() + writePos;
+    }
+
+    int getWindowSize() const { return windowSize; }
+    int getHopSize() const { return hopSize; }
+
+private:
+    std::vector<float> storage;  // 2 * windowSize samples: the ring plus its mirror.
+    int windowSize = 0;  // Length of each analysis frame.
+    int hopSize = 0;  // Samples between the starts of consecutive frames.
+    int writePos = 0;  // Next write index within the first half of storage.
+    int samplesUntilNextFrame = 0;  // Countdown to the next frame boundary.
+    bool frameReady = false;  // Set when a hop boundary has been reached and not yet consumed.
+};
@@ -0,0 +1,159 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Process-wide pool of analysis threads shared by every plugin instance in the host.
+ *
+ * Each instance in background mode registers a Job (its PitchAnalysisWorker). A few worker threads
+ * sweep the registered jobs and run whatever input each has queued, so one wake-up serves every
+ * instance with pending frames and the work spreads over cores. With many instances this costs far
+ * fewer threads and wake-ups than one thread per instance, and no host audio thread runs YIN.
+ *
+ * Use it through juce::SharedResourcePointer<AnalysisScheduler>: the pool is created with the first
+ * instance that needs it and shut down with the last. A job is only ever run by one worker at a
+ * time, so its detector state needs no locking, and results go back through each instance's own
+ * SeqLock. Neither the audio threads nor the workers take locks.
+ */
+class AnalysisScheduler
+{
+public:
+    /** Work submitted by one plugin instance. */
+    class Job
+    {
+    public:
+        virtual ~Job() = default;
+
+        /** Processes everything queued so far. Returns false if there was nothing to do. */
+        virtual bool runPending() = 0;
+    };
+
+    static const int maxJobs = 64;
+    static const int maxWorkers = 4;
+
+    AnalysisScheduler()
+    {
+        // Leave a core for the host's audio and message threads
+        const int numWorkers = juce::jlimit(1, maxWorkers, juce::SystemStats::getNumCpus() / 2);
+        for (int i = 0; i < numWorkers; ++i)
+            workers.add(new Worker(*this, i))->startThread(juce::Thread::Priority::high);
+    }
+
+    ~AnalysisScheduler()
+    {
+        for (auto* worker : workers)
+            worker->signalThreadShouldExit();
+        for (auto* worker : workers)
+            worker->stopThread(1000);
+    }
+
+    /**
+     * Registers a job with the workers. Returns false if every slot is taken, in which case the
+     * caller should analyse on its own. Not real-time safe.
+     */
+    bool add(Job& job)
+    {
+        for (auto& slot : slots)
+        {
+            Job* expected = nullptr;
+            if (slot.job.compare_exchange_strong(expected, &job))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Unregisters a job, waiting for a worker that is running it to finish. Once this returns no
+     * worker will touch the job again. Not real-time safe.
+     */
+    void remove(Job& job)
+    {
+        for (auto& slot : slots)
+        {
+            Job* expected = &job;
+            if (slot.job.compare_exchange_strong(expected, nullptr))
+            {
+                while (slot.busy.load())
+                    juce::Thread::yield();
+                return;
+            }
+        }
+    }
+
+    int getNumWorkers() const { return workers.size(); }
+
+private:
+    struct Slot
+    {
+        std::atomic<Job*> job { nullptr };
+        std::atomic<bool> busy { false };  // Held by the worker running this slot's job.
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(AnalysisScheduler& s, int index)
+            : juce::Thread("BassBud analysis " + juce::String(index + 1)), scheduler(s), firstSlot(index)
+        {
+        }
+
+        /**
+         * Audio threads never signal the workers, so they never touch a lock; the workers poll
+         * instead. While any job has had work recently (a host is streaming audio) they poll every
+         * pollIntervalMs, and once nothing has come in for idleAfterMs they drop to
+         * idlePollIntervalMs, so a stopped host is not woken a thousand times a second per worker.
+         */
+        void run() override
+        {
+            auto lastWorkMs = juce::Time::getMillisecondCounter();
+
+            while (! threadShouldExit())
+            {
+                const auto nowMs = juce::Time::getMillisecondCounter();
+                if (scheduler.runPendingJobs(firstSlot))
+                    lastWorkMs = nowMs;
+                else
+                    wait(nowMs - lastWorkMs < idleAfterMs ? pollIntervalMs : idlePollIntervalMs);
+            }
+        }
+
+    private:
+        AnalysisScheduler& scheduler;
+        int firstSlot;  // Workers start their sweeps at different slots so they pick up different jobs.
+    };
+
+    static constexpr int pollIntervalMs = 1;  // Longest a worker sleeps between sweeps while jobs are active.
+    static constexpr uint32_t idleAfterMs = 200;  // Longer than any host block, so streaming never counts as idle.
+    static constexpr int idlePollIntervalMs = 20;  // Well inside the FIFOs' latency headroom, so waking late drops nothing.
+
+    std::array<Slot, maxJobs> slots;
+    juce::OwnedArray<Worker> workers;
+
+    /**
+     * One sweep over every registered job, skipping jobs another worker is already running.
+     * Returns true if any job had work.
+     */
+    bool runPendingJobs(int firstSlot)
+    {
+        bool didWork = false;
+
+        for (int i = 0; i < maxJobs; ++i)
+        {
+            auto& slot = slots[static_cast<size_t>((firstSlot + i) % maxJobs)];
+            if (slot.job.load() == nullptr || slot.busy.exchange(true))
+                continue;
+
+            // The job is read again under the busy flag: remove() clears it first and then waits
+            // for the flag, so a job seen here stays alive until the flag is released
+            if (auto* job = slot.job.load())
+                didWork = job->runPending() || didWork;
+
+            slot.busy.store(false);
+        }
+
+        return didWork;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisScheduler)
+};
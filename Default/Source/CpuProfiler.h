@@ -0,0 +1,176 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * Build switch for the timers below. Set BASSBUD_PROFILING to 0 in the project's preprocessor
+ * definitions and every BASSBUD_PROFILE_SCOPE compiles to nothing; the histograms stay, but empty.
+ */
+#ifndef BASSBUD_PROFILING
+ #define BASSBUD_PROFILING 1
+#endif
+
+/**
+ * Lightweight timing of the audio callback and of each detector stage, for checking in the field
+ * how much of the callback budget BassBud uses.
+ *
+ * Durations go into fixed power-of-two histograms. Each histogram has one writer at a time (the
+ * audio thread, or whichever scheduler worker runs that channel), so recording is a clock read and
+ * a few relaxed stores with no read-modify-write; any thread can read them for a report while they
+ * are being written.
+ */
+namespace CpuProfiler
+{
+    enum class Stage
+    {
+        processBlock,  // The whole host callback.
+        prefilter,
+        difference,  // YIN Step 1.
+        cmnd,  // Step 2 past the first dip, for the pYIN candidates.
+        threshold,  // Step 3, with Step 2 as far as it searches, and the pYIN candidates.
+        interpolation,  // Step 4.
+        noteTracking  // Smoothing or HMM decoding of one frame.
+    };
+
+    inline constexpr int numStages = 7;
+    inline constexpr const char* stageNames[numStages] = {
+        "process_block", "prefilter", "difference", "cmnd", "threshold", "interpolation", "note_tracking"
+    };
+
+    /** Monotonic time in nanoseconds. */
+    inline int64_t now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline constexpr int numBuckets = 32;  // Bucket b holds durations below 2^(b+1) ns; the last one also holds anything longer.
+
+    /** A plain copy of one or more histograms, for reporting. */
+    struct Summary
+    {
+        std::array<uint64_t, numBuckets> buckets {};
+        uint64_t count = 0;
+        uint64_t totalNanoseconds = 0;
+        int64_t maxNanoseconds = 0;
+
+        double getMeanNanoseconds() const { return count > 0 ? static_cast<double>(totalNanoseconds) / static_cast<double>(count) : 0.0; }
+
+        /** Upper edge of the bucket that holds the given fraction (0..1) of the durations. */
+        int64_t getPercentileNanoseconds(double fraction) const
+        {
+            const auto target = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+            uint64_t seen = 0;
+            for (int b = 0; b < numBuckets; ++b)
+            {
+                seen += buckets[static_cast<size_t>(b)];
+                if (seen >= target && seen > 0)
+                    return std::min(int64_t { 2 } << b, maxNanoseconds);
+            }
+            return maxNanoseconds;
+        }
+    };
+
+    class Histogram
+    {
+    public:
+        /** Adds one duration. Only the histogram's current writer may call this. */
+        void record(int64_t nanoseconds) noexcept
+        {
+            int bucket = 0;
+            while (bucket < numBuckets - 1 && (nanoseconds >> (bucket + 1)) > 0)
+                ++bucket;
+
+            increment(buckets[static_cast<size_t>(bucket)], 1);
+            increment(count, 1);
+            increment(totalNanoseconds, static_cast<uint64_t>(std::max<int64_t>(0, nanoseconds)));
+            if (nanoseconds > maxNanoseconds.load(std::memory_order_relaxed))
+                maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+        }
+
+        /** Empties the histogram. Only call while nothing is writing to it. */
+        void clear() noexcept
+        {
+            for (auto& bucket : buckets)
+                bucket.store(0, std::memory_order_relaxed);
+            count.store(0, std::memory_order_relaxed);
+            totalNanoseconds.store(0, std::memory_order_relaxed);
+            maxNanoseconds.store(0, std::memory_order_relaxed);
+        }
+
+        /** Adds this histogram's current contents to a summary. Safe from any thread. */
+        void addTo(Summary& summary) const noexcept
+        {
+            for (int b = 0; b < numBuckets; ++b)
+                summary.buckets[static_cast<size_t>(b)] += buckets[static_cast<size_t>(b)].load(std::memory_order_relaxed);
+            summary.count += count.load(std::memory_order_relaxed);
+            summary.totalNanoseconds += totalNanoseconds.load(std::memory_order_relaxed);
+            summary.maxNanoseconds = std::max(summary.maxNanoseconds, maxNanoseconds.load(std::memory_order_relaxed));
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, numBuckets> buckets {};
+        std::atomic<uint64_t> count { 0 };
+        std::atomic<uint64_t> totalNanoseconds { 0 };
+        std::atomic<int64_t> maxNanoseconds { 0 };
+
+        // Single writer, so a plain load and store is enough and avoids a locked instruction
+        static void increment(std::atomic<uint64_t>& value, uint64_t amount) noexcept
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    };
+
+    /** One histogram per stage, written by one thread at a time. */
+    class StageTimes
+    {
+    public:
+        Histogram& operator[](Stage stage) noexcept { return histograms[static_cast<size_t>(stage)]; }
+        const Histogram& operator[](Stage stage) const noexcept { return histograms[static_cast<size_t>(stage)]; }
+
+        void clear() noexcept
+        {
+            for (auto& histogram : histograms)
+                histogram.clear();
+        }
+
+    private:
+        std::array<Histogram, numStages> histograms;
+    };
+
+    /** Records the time from construction to destruction under a stage, if times is not null. */
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(StageTimes* timesToUse, Stage stageToTime) noexcept
+            : times(timesToUse), stage(stageToTime), start(timesToUse != nullptr ? now() : 0)
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            if (times != nullptr)
+                (*times)[stage].record(now() - start);
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        StageTimes* times;
+        Stage stage;
+        int64_t start;
+    };
+}
+
+#if BASSBUD_PROFILING
+ #define BASSBUD_PROFILE_JOIN_(a, b) a##b
+ #define BASSBUD_PROFILE_JOIN(a, b) BASSBUD_PROFILE_JOIN_(a, b)
+ /** Times the rest of the enclosing scope into a CpuProfiler::StageTimes pointer (which may be null). */
+ #define BASSBUD_PROFILE_SCOPE(times, stage) const CpuProfiler::ScopedTimer BASSBUD_PROFILE_JOIN(bassbudProfileTimer, __LINE__) (times, stage)
+#else
+ #define BASSBUD_PROFILE_SCOPE(times, stage)
+#endif
@@ -0,0 +1,260 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Always-on record of the detector's recent decisions, for finding out afterwards why a wrong note
+ * was shown.
+ *
+ * Every analysis frame adds one Entry to a ring holding the last `capacity` frames. record() is
+ * called by whichever thread runs the tracker (one writer at a time, as with SeqLock) and only
+ * copies a few words: no allocation, no lock, and its memory is fixed when the recorder is built,
+ * so it stays enabled in release builds. The ring is stored as atomic words, so snapshot() can copy
+ * it from any thread while it is being written; entries the writer reached during the copy are
+ * dropped rather than returned torn.
+ *
+ * Snapshots are saved in a compact binary format (write() and read()), which the BassBudTools
+ * "flightlog" command decodes.
+ */
+class FlightRecorder
+{
+public:
+    static const int capacity = 4096;  // Frames kept: about 40 s at the default hop.
+
+    /** What the tracker did with one analysis frame. */
+    struct Entry
+    {
+        int64_t frameSample = 0;  // Input sample at the end of the frame, counted from prepareToPlay.
+        float rawPitch = 0.0f;  // Full-window YIN pitch in Hz, 0 if unvoiced or the gate was closed.
+        float trackedPitch = 0.0f;  // The note tracking's pitch: the smoothed pitch, or the HMM's decision.
+        float publishedPitch = 0.0f;  // Pitch shown after this frame, 0 if none.
+        float cmndMinimum = 1.0f;  // Lowest CMND value over the lags searched; 1 if YIN did not run.
+        float confidence = 0.0f;
+        float voicedProbability = 0.0f;
+        int16_t stableFrameCount = 0;  // The stability gate's counter (0 in probabilistic mode).
+        int8_t midiNoteNumber = -1;
+        int8_t string = -1;
+        int8_t fret = -1;
+        uint8_t flags = 0;  // Flag bits below.
+        int16_t reserved = 0;
+        int32_t blockSize = 0;  // Samples in the last host block completed before the frame.
+        float blockMicroseconds = 0.0f;  // How long that block's processBlock took.
+    };
+
+    enum Flags : uint8_t
+    {
+        provisional = 1,  // The published note came from the fast-attack window.
+        gateOpen = 2,  // YIN ran on the frame.
+        probabilistic = 4  // Notes were tracked by the HMM rather than the stability gate.
+    };
+
+    /** A saved snapshot of every channel's recorder. */
+    struct Recording
+    {
+        struct Channel
+        {
+            int index = 0;  // Input channel.
+            int stringIndex = -1;  // The string it carries in per-string mode, or -1.
+            std::vector<Entry> entries;  // Oldest first.
+        };
+
+        double sampleRate = 0.0;  // Host rate: frameSample / sampleRate is seconds since prepareToPlay.
+        double analysisSampleRate = 0.0;
+        int windowSize = 0;  // Analysis settings, in samples at the analysis rate.
+        int hopSize = 0;
+        std::vector<Channel> channels;
+    };
+
+    FlightRecorder() : words(static_cast<size_t>(capacity) * wordsPerEntry) {}
+
+    /** Adds one frame, overwriting the oldest once the ring is full. Only one thread may call this at a time. */
+    void record(const Entry& entry) noexcept
+    {
+        std::array<uint32_t, wordsPerEntry> entryWords;
+        std::memcpy(entryWords.data(), &entry, sizeof(Entry));
+
+        // The fence orders the last store to written before the slot's stores, so a reader that sees
+        // any of the new words also sees that the slot is being reused
+        const auto index = written.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto* slot = words.data() + (index % capacity) * wordsPerEntry;
+        for (size_t i = 0; i < wordsPerEntry; ++i)
+            slot[i].store(entryWords[i], std::memory_order_relaxed);
+
+        written.store(index + 1, std::memory_order_release);
+    }
+
+    /** Empties the ring. Only call while nothing is recording. */
+    void clear() noexcept { written.store(0); }
+
+    /** Frames recorded since the last clear(), including those already overwritten. */
+    uint64_t getNumRecorded() const noexcept { return written.load(std::memory_order_relaxed); }
+
+    /**
+     * Copies the frames still in the ring, oldest first: the last capacity - 1, since the oldest
+     * slot may be the one being rewritten. Safe from any thread, but allocates.
+     */
+    std::vector<Entry> snapshot() const
+    {
+        const auto end = written.load(std::memory_order_acquire);
+        const auto begin = end > capacity ? end - capacity : 0;
+
+        std::vector<std::array<uint32_t, wordsPerEntry>> copied(static_cast<size_t>(end - begin));
+        for (auto index = begin; index < end; ++index)
+        {
+            const auto* slot = words.data() + (index % capacity) * wordsPerEntry;
+            for (size_t i = 0; i < wordsPerEntry; ++i)
+                copied[static_cast<size_t>(index - begin)][i] = slot[i].load(std::memory_order_relaxed);
+        }
+
+        // Entry n shares its slot with entry n + capacity, which the writer may have started once
+        // written reached n + capacity
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto writtenAfterCopy = written.load(std::memory_order_relaxed);
+        const auto firstIntact = std::max(begin, writtenAfterCopy >= capacity ? writtenAfterCopy - capacity + 1 : 0);
+
+        std::vector<Entry> entries(static_cast<size_t>(end - std::min(end, firstIntact)));
+        for (size_t i = 0; i < entries.size(); ++i)
+            std::memcpy(static_cast<void*>(&entries[i]), copied[static_cast<size_t>(firstIntact - begin) + i].data(), sizeof(Entry));
+        return entries;
+    }
+
+    static constexpr const char* fileExtension = ".bbfr";
+
+    /** Writes a recording. Every value is stored little-endian, so files move between machines. */
+    static void write(juce::OutputStream& out, const Recording& recording)
+    {
+        out.write(fileMagic, sizeof(fileMagic));
+        out.writeInt(formatVersion);
+        out.writeDouble(recording.sampleRate);
+        out.writeDouble(recording.analysisSampleRate);
+        out.writeInt(recording.windowSize);
+        out.writeInt(recording.hopSize);
+        out.writeInt(static_cast<int>(recording.channels.size()));
+
+        for (const auto& channel : recording.channels)
+        {
+            out.writeInt(channel.index);
+            out.writeInt(channel.stringIndex);
+            out.writeInt(static_cast<int>(channel.entries.size()));
+
+            for (const auto& entry : channel.entries)
+            {
+                out.writeInt64(entry.frameSample);
+                for (float value : { entry.rawPitch, entry.trackedPitch, entry.publishedPitch,
+                                     entry.cmndMinimum, entry.confidence, entry.voicedProbability })
+                    out.writeFloat(value);
+                out.writeShort(entry.stableFrameCount);
+                out.writeByte(static_cast<char>(entry.midiNoteNumber));
+                out.writeByte(static_cast<char>(entry.string));
+                out.writeByte(static_cast<char>(entry.fret));
+                out.writeByte(static_cast<char>(entry.flags));
+                out.writeInt(entry.blockSize);
+                out.writeFloat(entry.blockMicroseconds);
+            }
+        }
+    }
+
+    /**
+     * Writes a recording to a file on a background thread, so the message thread never waits for
+     * the disk. Returns at once; if the file cannot be opened or written, onFailure is called on
+     * that thread with the reason.
+     */
+    static void saveAsync(std::shared_ptr<const Recording> recording, const juce::File& file,
+                          std::function<void (const juce::String& error)> onFailure)
+    {
+        juce::Thread::launch([recording, file, onFailure = std::move(onFailure)]
+        {
+            juce::FileOutputStream out(file);
+            auto result = out.getStatus();  // Fails if the file could not be opened
+            if (result.wasOk())
+                result = out.setPosition(0) ? out.truncate() : juce::Result::fail("Cannot seek to the start of the file");
+
+            if (result.wasOk())
+            {
+                write(out, *recording);
+                out.flush();
+                result = out.getStatus();  // Fails if any write did
+            }
+
+            if (result.wasOk())
+                return;
+
+            onFailure("Cannot write " + file.getFullPathName() + ": " + result.getErrorMessage());
+        });
+    }
+
+    /** Reads a recording written by write(). Returns false if the data is not one or is cut short. */
+    static bool read(juce::InputStream& in, Recording& recording)
+    {
+        // A stream that does not know its length (-1) is trusted to hold whole channels
+        const auto hasBytes = [&in] (int64_t numBytes) { return in.getNumBytesRemaining() < 0 || in.getNumBytesRemaining() >= numBytes; };
+
+        char magic[sizeof(fileMagic)] {};
+        if (in.read(magic, static_cast<int>(sizeof(magic))) != static_cast<int>(sizeof(magic)) || std::memcmp(magic, fileMagic, sizeof(magic)) != 0
+            || in.readInt() != formatVersion)
+            return false;
+
+        recording.sampleRate = in.readDouble();
+        recording.analysisSampleRate = in.readDouble();
+        recording.windowSize = in.readInt();
+        recording.hopSize = in.readInt();
+
+        const int numChannels = in.readInt();
+        if (numChannels < 0 || numChannels > maxFileChannels)
+            return false;
+
+        recording.channels.assign(static_cast<size_t>(numChannels), {});
+        for (auto& channel : recording.channels)
+        {
+            if (! hasBytes(3 * sizeof(int32_t)))
+                return false;
+
+            channel.index = in.readInt();
+            channel.stringIndex = in.readInt();
+
+            const int numEntries = in.readInt();
+            if (numEntries < 0 || numEntries > capacity || ! hasBytes(static_cast<int64_t>(numEntries) * entryFileBytes))
+                return false;
+
+            channel.entries.assign(static_cast<size_t>(numEntries), {});
+            for (auto& entry : channel.entries)
+            {
+                entry.frameSample = in.readInt64();
+                for (float* value : { &entry.rawPitch, &entry.trackedPitch, &entry.publishedPitch,
+                                      &entry.cmndMinimum, &entry.confidence, &entry.voicedProbability })
+                    *value = in.readFloat();
+                entry.stableFrameCount = in.readShort();
+                entry.midiNoteNumber = static_cast<int8_t>(in.readByte());
+                entry.string = static_cast<int8_t>(in.readByte());
+                entry.fret = static_cast<int8_t>(in.readByte());
+                entry.flags = static_cast<uint8_t>(in.readByte());
+                entry.blockSize = in.readInt();
+                entry.blockMicroseconds = in.readFloat();
+            }
+        }
+
+        return true;
+    }
+
+private:
+    static_assert(std::is_trivially_copyable<Entry>::value, "Entries are copied as raw words");
+    static constexpr size_t wordsPerEntry = (sizeof(Entry) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    static constexpr char fileMagic[4] = { 'B', 'B', 'F', 'R' };
+    static const int formatVersion = 1;
+    static const int maxFileChannels = 64;
+    static const int entryFileBytes = 46;  // An Entry as write() stores it, without the padding.
+
+    std::vector<std::atomic<uint32_t>> words;  // capacity entries of wordsPerEntry words each.
+    std::atomic<uint64_t> written { 0 };  // Entries recorded; entry n lives in slot n % capacity.
+};
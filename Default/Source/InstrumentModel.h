@@ -0,0 +1,233 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * Compile-time model of the instrument and of scales, shared by the pitch tracker and the editor.
+ *
+ * Notes are MIDI note numbers and pitch classes are note % 12 (0 = C). Scales are 12-bit masks
+ * with bit n set when pitch class n belongs to the scale, so "is this fret in the scale" is one bit
+ * test. Frequencies map to notes through a table of note boundaries rather than a log2 per call.
+ */
+namespace InstrumentModel
+{
+    //==============================================================================
+    // Notes and frequencies
+
+    /** Frequency of every MIDI note (A4 = 440 Hz = 69), built without std::pow so it can be constexpr. */
+    constexpr std::array<double, 128> makeNoteFrequencies()
+    {
+        constexpr double semitone = 1.0594630943592952646;  // 2^(1/12)
+        std::array<double, 128> frequencies {};
+
+        frequencies[69] = 440.0;
+        for (int n = 70; n < 128; ++n)
+            frequencies[n] = frequencies[n - 1] * semitone;
+        for (int n = 68; n >= 0; --n)
+            frequencies[n] = frequencies[n + 1] / semitone;
+
+        return frequencies;
+    }
+
+    inline constexpr auto noteFrequencies = makeNoteFrequencies();
+
+    /** noteBoundaries[n] is the frequency half a semitone below note n: the lowest that rounds to n. */
+    constexpr std::array<float, 128> makeNoteBoundaries()
+    {
+        constexpr double quarterTone = 1.0293022366434920288;  // 2^(1/24)
+        std::array<float, 128> boundaries {};
+
+        for (int n = 0; n < 128; ++n)
+            boundaries[n] = static_cast<float>(noteFrequencies[n] / quarterTone);
+
+        return boundaries;
+    }
+
+    inline constexpr auto noteBoundaries = makeNoteBoundaries();
+
+    constexpr float getNoteFrequency(int midiNoteNumber) { return static_cast<float>(noteFrequencies[midiNoteNumber & 127]); }
+
+    /** Nearest MIDI note to a frequency, by binary search of the boundary table; -1 below note 0. */
+    constexpr int frequencyToMidiNote(float frequency)
+    {
+        int low = 0, high = 128;  // Find the first boundary above the frequency.
+        while (low < high)
+        {
+            const int mid = (low + high) / 2;
+            if (noteBoundaries[mid] <= frequency)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low - 1;
+    }
+
+    constexpr int getPitchClass(int midiNoteNumber) { return midiNoteNumber % 12; }
+
+    //==============================================================================
+    // Scales
+
+    /** Scales and modes, in the order the editor offers them. */
+    enum class Scale : uint8_t
+    {
+        ionian, dorian, phrygian, lydian, mixolydian, aeolian, locrian,
+        majorPentatonic, minorPentatonic, blues, harmonicMinor
+    };
+
+    inline constexpr int numScales = 11;
+
+    inline constexpr const char* scaleNames[numScales] = {
+        "Ionian (Major)", "Dorian", "Phrygian", "Lydian", "Mixolydian", "Aeolian (Natural Minor)", "Locrian",
+        "Major Pentatonic", "Minor Pentatonic", "Blues", "Harmonic Minor"
+    };
+
+    constexpr uint16_t makeIntervalMask(std::initializer_list<int> semitones)
+    {
+        uint16_t mask = 0;
+        for (int semitone : semitones)
+            mask = static_cast<uint16_t>(mask | (1u << semitone));
+        return mask;
+    }
+
+    /** Each scale relative to its root: bit n is set if n semitones above the root is in the scale. */
+    inline constexpr uint16_t scaleIntervals[numScales] = {
+        makeIntervalMask({ 0, 2, 4, 5, 7, 9, 11 }),  // Ionian (Major)
+        makeIntervalMask({ 0, 2, 3, 5, 7, 9, 10 }),  // Dorian
+        makeIntervalMask({ 0, 1, 3, 5, 7, 8, 10 }),  // Phrygian
+        makeIntervalMask({ 0, 2, 4, 6, 7, 9, 11 }),  // Lydian
+        makeIntervalMask({ 0, 2, 4, 5, 7, 9, 10 }),  // Mixolydian
+        makeIntervalMask({ 0, 2, 3, 5, 7, 8, 10 }),  // Aeolian (Natural Minor)
+        makeIntervalMask({ 0, 1, 3, 5, 6, 8, 10 }),  // Locrian
+        makeIntervalMask({ 0, 2, 4, 7, 9 }),         // Major pentatonic
+        makeIntervalMask({ 0, 3, 5, 7, 10 }),        // Minor pentatonic
+        makeIntervalMask({ 0, 3, 5, 6, 7, 10 }),     // Blues
+        makeIntervalMask({ 0, 2, 3, 5, 7, 8, 11 })   // Harmonic minor
+    };
+
+    /** Pitch-class masks for every scale and root: [scale][root pitch class]. */
+    constexpr std::array<std::array<uint16_t, 12>, numScales> makeScaleMasks()
+    {
+        std::array<std::array<uint16_t, 12>, numScales> masks {};
+
+        for (int scale = 0; scale < numScales; ++scale)
+        {
+            for (int root = 0; root < 12; ++root)
+            {
+                const unsigned intervals = scaleIntervals[scale];
+                masks[scale][root] = static_cast<uint16_t>(((intervals << root) | (intervals >> (12 - root))) & 0xfff);  // Rotate up by root.
+            }
+        }
+
+        return masks;
+    }
+
+    inline constexpr auto scaleMasks = makeScaleMasks();
+
+    constexpr uint16_t getScaleMask(Scale scale, int rootPitchClass) { return scaleMasks[static_cast<int>(scale)][rootPitchClass]; }
+    constexpr bool isInScale(uint16_t scaleMask, int pitchClass) { return ((scaleMask >> pitchClass) & 1) != 0; }
+
+    //==============================================================================
+    // Instruments
+
+    /** A string and fret; both -1 when a note cannot be played. */
+    struct Position
+    {
+        int string = -1;  // 0 is the lowest string.
+        int fret = -1;
+    };
+
+    /**
+     * A fretted instrument with up to maxStrings strings in any tuning and up to maxFrets frets.
+     * The note at every position and the preferred position of every MIDI note are tabulated when
+     * the instrument is constructed, so lookups are plain array reads.
+     */
+    class Instrument
+    {
+    public:
+        static constexpr int maxStrings = 6;
+        static constexpr int maxFrets = 24;
+
+        /** openStringNotes are MIDI notes, lowest string first; extra strings beyond maxStrings are ignored. */
+        constexpr Instrument(std::initializer_list<int> openStringNotes, int frets)
+            : Instrument(openStringNotes.begin(), static_cast<int>(openStringNotes.size()), frets)
+        {
+        }
+
+        constexpr Instrument(const int* openStringNotes, int numOpenStrings, int frets)
+            : numFrets(frets < 0 ? 0 : (frets > maxFrets ? maxFrets : frets))
+        {
+            for (int i = 0; i < numOpenStrings && numStrings < maxStrings; ++i)
+                openNotes[numStrings++] = openStringNotes[i];
+
+            for (int s = 0; s < numStrings; ++s)
+                for (int f = 0; f <= numFrets; ++f)
+                    notes[s][f] = openNotes[s] + f;
+
+            // Each note goes on the highest string that reaches it, i.e. at the lowest fret. This assumes
+            // the strings are tuned in ascending order, as they are on every bass.
+            for (int note = 0; note < 128; ++note)
+            {
+                for (int s = numStrings - 1; s >= 0; --s)
+                {
+                    const int fret = note - openNotes[s];
+                    if (fret >= 0 && fret <= numFrets)
+                    {
+                        positions[note] = { s, fret };
+                        break;
+                    }
+                }
+            }
+        }
+
+        constexpr int getNumStrings() const { return numStrings; }
+        constexpr int getNumFrets() const { return numFrets; }
+        constexpr int getOpenStringNote(int string) const { return openNotes[string]; }
+        constexpr int getNoteAt(int string, int fret) const { return notes[string][fret]; }
+        constexpr int getPitchClassAt(int string, int fret) const { return getPitchClass(notes[string][fret]); }
+
+        /** Where a MIDI note is played, or {-1, -1} if it is out of range. */
+        constexpr Position getPosition(int midiNoteNumber) const
+        {
+            return midiNoteNumber >= 0 && midiNoteNumber < 128 ? positions[midiNoteNumber] : Position();
+        }
+
+        constexpr int getLowestNote() const { return openNotes[0]; }
+        constexpr int getHighestNote() const { return openNotes[numStrings - 1] + numFrets; }
+
+        /** Same tuning and fret count; everything else is derived from those. */
+        constexpr bool operator==(const Instrument& other) const
+        {
+            if (numStrings != other.numStrings || numFrets != other.numFrets)
+                return false;
+
+            for (int s = 0; s < numStrings; ++s)
+                if (openNotes[s] != other.openNotes[s])
+                    return false;
+
+            return true;
+        }
+
+        constexpr bool operator!=(const Instrument& other) const { return ! (*this == other); }
+
+    private:
+        int numStrings = 0;
+        int numFrets = 0;
+        std::array<int, maxStrings> openNotes {};
+        std::array<std::array<int, maxFrets + 1>, maxStrings> notes {};  // MIDI note at each string/fret.
+        std::array<Position, 128> positions {};  // Preferred string/fret for each MIDI note.
+    };
+
+    inline constexpr Instrument standardBass4 { { 28, 33, 38, 43 }, 24 };  // E1 A1 D2 G2
+    inline constexpr Instrument standardBass5 { { 23, 28, 33, 38, 43 }, 24 };  // B0 E1 A1 D2 G2
+    inline constexpr Instrument standardBass6 { { 23, 28, 33, 38, 43, 48 }, 24 };  // B0 E1 A1 D2 G2 C3
+
+    /** The presets in the order the plugin offers them. */
+    inline constexpr int numPresets = 3;
+    inline constexpr const Instrument* presets[numPresets] = { &standardBass4, &standardBass5, &standardBass6 };
+    inline constexpr const char* presetNames[numPresets] = { "4-String Bass", "5-String Bass", "6-String Bass" };
+
+    static_assert(frequencyToMidiNote(41.2f) == 28 && frequencyToMidiNote(440.0f) == 69, "Note boundary table is off");
+    static_assert(standardBass4.getPosition(40).string == 2 && standardBass4.getPosition(40).fret == 2, "E2 is the D string, 2nd fret");
+    static_assert(isInScale(getScaleMask(Scale::ionian, 0), 4) && ! isInScale(getScaleMask(Scale::ionian, 0), 3), "C major has E, not D#");
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include "AnalysisGate.h"
+
+/**
+ * Turns the tracker's note changes into MIDI note-on/off events placed at sample positions in the
+ * host's blocks.
+ *
+ * A note-on is timed from the onset of the note in the input, not from when detection finished:
+ * it is scheduled latencySamples after the onset, and the plugin reports that latency to the host,
+ * which shifts the events back onto the attack. The rare note detected later than that goes out as
+ * soon as it is known. A note-on that has not been sent yet when the tracker changes its mind (a
+ * provisional note corrected by the full window) is withdrawn rather than followed by a note-off.
+ * Note-offs go out at the frame that saw the note end. Release detection already lags the real
+ * release by about a window, which is roughly what the host's latency compensation removes again.
+ *
+ * Events wait in a small fixed queue, so nothing here allocates on the audio thread.
+ */
+class MidiNoteOutput
+{
+public:
+    static const int maxPendingEvents = 16;
+
+    /** Sets the MIDI channel (1-16) and the fixed delay from onset to note-on, and clears all state. */
+    void prepare(int midiChannelToUse, int latencyInputSamples)
+    {
+        midiChannel = juce::jlimit(1, 16, midiChannelToUse);
+        latencySamples = latencyInputSamples;
+        reset();
+    }
+
+    void reset()
+    {
+        numPending = 0;
+        currentNote = -1;
+        lastEventTime = 0;
+        lastOnsetUsed = -1;
+    }
+
+    /**
+     * Called after every analysis frame. note is the tracker's MIDI note (or -1); frameTime is the
+     * input sample at which the frame was analysed, and onsetTime / onsetLevelDb describe the most
+     * recent attack (onsetTime -1 if none). All times count input samples from the same origin.
+     */
+    void update(int note, int64_t frameTime, int64_t onsetTime, float onsetLevelDb)
+    {
+        if (note == currentNote || numPending + 2 > maxPendingEvents)
+            return;  // Unchanged, or the queue is full and the change is retried on the next frame
+
+        int64_t time = std::max(frameTime, lastEventTime);
+
+        // A new note with an attack that has not started a note yet is timed from that attack
+        if (note >= 0 && onsetTime >= 0 && onsetTime != lastOnsetUsed)
+        {
+            time = std::max(time, onsetTime + latencySamples);
+            lastOnsetUsed = onsetTime;
+        }
+
+        if (currentNote >= 0)
+        {
+            const bool lastIsUnsentNoteOn = numPending > 0 && pending[static_cast<size_t>(numPending - 1)].velocity > 0;
+            if (lastIsUnsentNoteOn)
+                --numPending;  // Never sent, so take it back instead of sending a note-off
+            else
+                push({ time, currentNote, 0 });
+        }
+
+        if (note >= 0)
+            push({ time, note, velocityFromLevel(onsetLevelDb) });
+
+        currentNote = note;
+    }
+
+    /**
+     * Adds every event due before the end of the block to midi, at its offset from blockStart.
+     * Events that became due in an earlier block go at offset 0.
+     */
+    void renderBlock(juce::MidiBuffer& midi, int64_t blockStart, int numSamples)
+    {
+        int numDue = 0;
+        for (; numDue < numPending && pending[static_cast<size_t>(numDue)].time < blockStart + numSamples; ++numDue)
+        {
+            const auto& event = pending[static_cast<size_t>(numDue)];
+            const int offset = static_cast<int>(juce::jlimit<int64_t>(0, numSamples - 1, event.time - blockStart));
+
+            if (event.velocity > 0)
+                midi.addEvent(juce::MidiMessage::noteOn(midiChannel, event.note, event.velocity), offset);
+            else
+                midi.addEvent(juce::MidiMessage::noteOff(midiChannel, event.note), offset);
+        }
+
+        std::copy(pending.begin() + numDue, pending.begin() + numPending, pending.begin());
+        numPending -= numDue;
+    }
+
+    /** Maps the attack level, from the gate's open threshold up to 0 dBFS, onto velocities 1-127. */
+    static juce::uint8 velocityFromLevel(float levelDb)
+    {
+        const float amount = (levelDb - AnalysisGate::openThresholdDb) / -AnalysisGate::openThresholdDb;
+        return static_cast<juce::uint8>(juce::jlimit(1, 127, juce::roundToInt(1.0f + 126.0f * amount)));
+    }
+
+private:
+    struct Event
+    {
+        int64_t time;  // Input sample the event belongs at.
+        int note;
+        juce::uint8 velocity;  // 0 for a note-off.
+    };
+
+    std::array<Event, maxPendingEvents> pending {};  // In time order.
+    int numPending = 0;
+    int midiChannel = 1;
+    int latencySamples = 0;
+    int currentNote = -1;  // The note most recently turned on, sent or not, or -1.
+    int64_t lastEventTime = 0;  // Events are never scheduled before an earlier one.
+    int64_t lastOnsetUsed = -1;  // Onset that timed the latest note-on, so it only times one.
+
+    void push(const Event& event)
+    {
+        pending[static_cast<size_t>(numPending++)] = event;
+        lastEventTime = event.time;
+    }
+};
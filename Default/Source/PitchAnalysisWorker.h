@@ -0,0 +1,133 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <vector>
+#include "AnalysisScheduler.h"
+
+/**
+ * Runs one plugin instance's pitch analysis on the shared AnalysisScheduler pool instead of the
+ * host's audio thread.
+ *
+ * The audio thread only copies input samples into a single-producer/single-consumer FIFO
+ * (juce::AbstractFifo), which takes no locks and never allocates. A scheduler worker drains the
+ * FIFO and passes the samples, in order, to a consumer callback that runs the detector. The FIFO
+ * size bounds the added latency: if the workers fall further behind than that, new samples are
+ * dropped and counted as overflows rather than queued indefinitely.
+ *
+ * Well before that, a backlog means the published result is out of date: the consumer has not
+ * yet seen audio the host delivered a while ago. Each push that finds more than a set number of
+ * samples still waiting counts as an underrun of fresh results.
+ */
+class PitchAnalysisWorker : private AnalysisScheduler::Job
+{
+public:
+    using Consumer = std::function<void (const float* samples, int numSamples)>;
+
+    PitchAnalysisWorker() = default;
+    ~PitchAnalysisWorker() override { stop(); }
+
+    /**
+     * Sizes the FIFO to hold capacitySamples samples and registers with the shared scheduler. A
+     * push that finds more than staleBacklogSamples samples not yet analysed counts as an underrun.
+     * Returns false if the scheduler has no room, in which case nothing is started and the caller
+     * should analyse on the audio thread. Not real-time safe; call from prepareToPlay while audio is
+     * stopped.
+     */
+    bool start(int capacitySamples, int staleBacklogSamples, Consumer newConsumer)
+    {
+        stop();
+
+        consumer = std::move(newConsumer);
+        staleBacklog = staleBacklogSamples;
+        fifo.setTotalSize(capacitySamples + 1);  // AbstractFifo keeps one slot free.
+        fifo.reset();
+        storage.assign(static_cast<size_t>(capacitySamples) + 1, 0.0f);
+        overflowCount.store(0);
+        underrunCount.store(0);
+
+        scheduler.emplace();  // Creates the pool if this is the first instance to need it
+        running = scheduler->get().add(*this);
+        if (! running)
+            scheduler.reset();
+
+        return running;
+    }
+
+    /** Unregisters from the scheduler; samples still queued are discarded. */
+    void stop()
+    {
+        if (running)
+        {
+            scheduler->get().remove(*this);
+            running = false;
+        }
+        scheduler.reset();  // The pool shuts down once no instance holds it
+    }
+
+    bool isRunning() const { return running; }
+
+    /**
+     * Queues samples for analysis. Called from the audio thread; lock-free and allocation-free.
+     * Samples that do not fit are dropped and added to the overflow count.
+     */
+    void push(const float* samples, int numSamples) noexcept
+    {
+        if (fifo.getNumReady() > staleBacklog)
+            underrunCount.fetch_add(1, std::memory_order_relaxed);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            std::copy(samples, samples + size1, storage.begin() + start1);
+        if (size2 > 0)
+            std::copy(samples + size1, samples + size1 + size2, storage.begin() + start2);
+
+        fifo.finishedWrite(size1 + size2);
+
+        if (size1 + size2 < numSamples)
+            overflowCount.fetch_add(static_cast<uint32_t>(numSamples - size1 - size2), std::memory_order_relaxed);
+    }
+
+    /** Total number of input samples dropped because the workers had fallen behind. */
+    uint32_t getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+
+    /** Number of pushes (host blocks) that found the worker too far behind for its result to be current. */
+    uint32_t getUnderrunCount() const { return underrunCount.load(std::memory_order_relaxed); }
+
+    /** Upper bound on the delay, in samples, that the FIFO can add before samples are dropped. */
+    int getMaxLatencySamples() const { return fifo.getTotalSize() - 1; }
+
+private:
+    juce::AbstractFifo fifo { 1 };
+    std::vector<float> storage;  // Sample storage indexed by the AbstractFifo.
+    Consumer consumer;  // Runs the detector; only called by one scheduler worker at a time.
+    std::atomic<uint32_t> overflowCount { 0 };
+    std::atomic<uint32_t> underrunCount { 0 };
+    int staleBacklog = 0;  // Queued samples beyond which a push counts as an underrun.
+    std::optional<juce::SharedResourcePointer<AnalysisScheduler>> scheduler;  // Held only while running.
+    bool running = false;
+
+    /** Called by a scheduler worker: hands every queued sample to the consumer. */
+    bool runPending() override
+    {
+        const int numReady = fifo.getNumReady();
+        if (numReady == 0)
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            consumer(storage.data() + start1, size1);
+        if (size2 > 0)
+            consumer(storage.data() + start2, size2);
+
+        fifo.finishedRead(size1 + size2);
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PitchAnalysisWorker)
+};
@@ -0,0 +1,250 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "YinPitchDetector.h"
+
+/**
+ * Hidden Markov model over pitch, decoded online: the tracking half of pYIN.
+ *
+ * Each frame's YIN candidates (YinPitchDetector::getPitchCandidates()) are the observations. The
+ * hidden states are pitch bins of binCents across the tracked range, each either voiced or
+ * unvoiced, so an unvoiced gap still remembers the pitch around it. Between frames the pitch may
+ * glide by up to maxGlideCents with a triangular preference for small steps, jump anywhere (a new
+ * note) with noteJumpProbability, and switch voicing with voicingSwitchProbability.
+ *
+ * Decoding is Viterbi with a fixed lag: after each frame the most likely path is traced back
+ * lookbackFrames frames and the state it passes through there is the decision for that frame. The
+ * latency is therefore exactly lookbackFrames hops, and each frame costs the same regardless of
+ * the signal: every state has 2 * glide + 1 neighbours, and the jump to any bin only needs the
+ * best score of the previous frame, so the transition matrix is never stored in full.
+ *
+ * processFrame() is real-time safe once prepare() has been called.
+ */
+class PitchHmm
+{
+public:
+    static constexpr float binCents = 20.0f;
+    static constexpr float maxGlideCents = 240.0f;  // Largest pitch change between frames without a jump.
+    static constexpr float noteJumpProbability = 0.02f;  // Chance per frame of moving to any bin.
+    static constexpr float voicingSwitchProbability = 0.01f;
+    static constexpr float voicingTrust = 0.5f;  // How far the candidates' voicing probability is believed.
+    static constexpr int maxLookbackFrames = 16;
+    static constexpr float unlikelyObservation = 1.0e-6f;  // Floor for a voiced bin no candidate is near.
+
+    /** What the model decided for one frame. */
+    struct Decision
+    {
+        float pitch = 0.0f;  // Hz, or 0 if the frame is unvoiced.
+        float voicedProbability = 0.0f;  // The frame's total candidate probability, 0..1.
+    };
+
+    /** Sizes the model for a pitch range and decoding lag. Not real-time safe. */
+    void prepare(float minFrequency, float maxFrequency, int newLookbackFrames)
+    {
+        lowestFrequency = minFrequency;
+        numBins = std::max(1, static_cast<int>(std::ceil(1200.0f * std::log2(maxFrequency / minFrequency) / binCents)) + 1);
+        lookbackFrames = std::clamp(newLookbackFrames, 0, maxLookbackFrames);
+
+        // Glide weights fall off linearly with distance; the voiced and unvoiced halves use the same ones
+        glideBins = static_cast<int>(maxGlideCents / binCents);
+        logGlide.assign(static_cast<size_t>(2 * glideBins + 1), 0.0f);
+        float total = 0.0f;
+        for (int k = -glideBins; k <= glideBins; ++k)
+            total += static_cast<float>(glideBins + 1 - std::abs(k));
+        for (int k = -glideBins; k <= glideBins; ++k)
+            logGlide[static_cast<size_t>(k + glideBins)] = std::log((1.0f - voicingSwitchProbability) * (1.0f - noteJumpProbability)
+                                                                    * static_cast<float>(glideBins + 1 - std::abs(k)) / total);
+
+        logJump = std::log((1.0f - voicingSwitchProbability) * noteJumpProbability / static_cast<float>(numBins));
+        logSwitch = std::log(voicingSwitchProbability);
+
+        const auto numStates = static_cast<size_t>(2 * numBins);
+        scores.assign(numStates, 0.0f);
+        nextScores.assign(numStates, 0.0f);
+        observations.assign(numStates, 0.0f);
+        history.assign(static_cast<size_t>(lookbackFrames + 1), {});
+        for (auto& frame : history)
+            frame.backPointers.assign(numStates, 0);
+
+        reset();
+    }
+
+    /** Forgets every frame seen so far. */
+    void reset()
+    {
+        std::fill(scores.begin(), scores.end(), 0.0f);
+        framesProcessed = 0;
+    }
+
+    int getLookbackFrames() const { return lookbackFrames; }
+    int getNumBins() const { return numBins; }
+
+    /**
+     * Adds one frame's candidates (none for a silent frame) and returns the decision for the frame
+     * lookbackFrames earlier. Until that many frames have been seen the decision is unvoiced.
+     */
+    Decision processFrame(const YinPitchDetector::PitchCandidate* candidates, int numCandidates)
+    {
+        auto& frame = history[static_cast<size_t>(framesProcessed % static_cast<int64_t>(history.size()))];
+        setObservations(frame, candidates, numCandidates);
+        step(frame);
+        ++framesProcessed;
+
+        if (framesProcessed <= lookbackFrames)
+            return {};
+
+        // Trace the best path back to the frame being decided
+        int state = static_cast<int>(std::max_element(scores.begin(), scores.end()) - scores.begin());
+        int64_t index = framesProcessed - 1;
+        for (int k = 0; k < lookbackFrames; ++k, --index)
+            state = history[static_cast<size_t>(index % static_cast<int64_t>(history.size()))].backPointers[static_cast<size_t>(state)];
+
+        const auto& decided = history[static_cast<size_t>(index % static_cast<int64_t>(history.size()))];
+        Decision decision;
+        decision.voicedProbability = decided.voicedProbability;
+        if (state < numBins)
+            decision.pitch = getPitchNearBin(decided, state);
+        return decision;
+    }
+
+private:
+    /** What is kept of each frame until it has been decided. */
+    struct Frame
+    {
+        YinPitchDetector::PitchCandidate candidates[YinPitchDetector::maxPitchCandidates];
+        int numCandidates = 0;
+        float voicedProbability = 0.0f;
+        std::vector<int16_t> backPointers;  // Best previous state for each state.
+    };
+
+    float lowestFrequency = 40.0f;  // Centre of bin 0.
+    int numBins = 1;  // Voiced states are 0..numBins-1, unvoiced ones numBins..2*numBins-1.
+    int glideBins = 0;
+    int lookbackFrames = 0;
+    std::vector<float> logGlide;  // Log transition probability for each bin step -glideBins..glideBins.
+    float logJump = 0.0f;
+    float logSwitch = 0.0f;
+
+    std::vector<float> scores;  // Log score of the best path ending in each state, normalised to a maximum of 0.
+    std::vector<float> nextScores;
+    std::vector<float> observations;  // Log observation probability of each state for the current frame.
+    std::vector<Frame> history;  // The last lookbackFrames + 1 frames, indexed by frame number.
+    int64_t framesProcessed = 0;
+
+    /** Fractional bin index of a frequency. */
+    float getBinPosition(float frequency) const { return 1200.0f * std::log2(frequency / lowestFrequency) / binCents; }
+
+    int getBin(float frequency) const { return std::clamp(static_cast<int>(std::lround(getBinPosition(frequency))), 0, numBins - 1); }
+
+    /**
+     * pYIN's observation model: a voiced bin is as likely as the candidates in it (scaled by
+     * voicingTrust), and every unvoiced bin shares what the candidates leave over. Each candidate is
+     * split between the two bins either side of it, so a pitch moving across a bin edge changes the
+     * scores smoothly and the decisions do not hinge on rounding.
+     */
+    void setObservations(Frame& frame, const YinPitchDetector::PitchCandidate* candidates, int numCandidates)
+    {
+        frame.numCandidates = std::min(numCandidates, YinPitchDetector::maxPitchCandidates);
+        frame.voicedProbability = 0.0f;
+        std::fill(observations.begin(), observations.begin() + numBins, 0.0f);
+
+        for (int i = 0; i < frame.numCandidates; ++i)
+        {
+            frame.candidates[i] = candidates[i];
+            frame.voicedProbability += candidates[i].probability;
+
+            const float position = std::clamp(getBinPosition(candidates[i].frequency), 0.0f, static_cast<float>(numBins - 1));
+            const int lower = std::min(static_cast<int>(position), numBins - 2 < 0 ? 0 : numBins - 2);
+            const float upperShare = std::min(position - static_cast<float>(lower), 1.0f);
+            observations[static_cast<size_t>(lower)] += voicingTrust * candidates[i].probability * (1.0f - upperShare);
+            if (lower + 1 < numBins)
+                observations[static_cast<size_t>(lower + 1)] += voicingTrust * candidates[i].probability * upperShare;
+        }
+
+        frame.voicedProbability = std::min(frame.voicedProbability, 1.0f);
+        const float unvoiced = std::log((1.0f - voicingTrust * frame.voicedProbability) / static_cast<float>(numBins));
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            auto& observation = observations[static_cast<size_t>(bin)];
+            observation = std::log(observation + unlikelyObservation);
+            observations[static_cast<size_t>(numBins + bin)] = unvoiced;
+        }
+    }
+
+    /** One Viterbi step over the banded transition matrix. */
+    void step(Frame& frame)
+    {
+        // Best state of each half, for the jump to any bin of the same voicing
+        const auto bestVoiced = std::max_element(scores.begin(), scores.begin() + numBins);
+        const auto bestUnvoiced = std::max_element(scores.begin() + numBins, scores.end());
+        const int bestVoicedState = static_cast<int>(bestVoiced - scores.begin());
+        const int bestUnvoicedState = static_cast<int>(bestUnvoiced - scores.begin());
+
+        float maxScore = -INFINITY;
+
+        for (int half = 0; half < 2; ++half)
+        {
+            const int offset = half * numBins;
+            const int otherOffset = numBins - offset;
+            const int jumpState = half == 0 ? bestVoicedState : bestUnvoicedState;
+            const float jumpScore = scores[static_cast<size_t>(jumpState)] + logJump;
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                float best = jumpScore;
+                int from = jumpState;
+
+                const int first = std::max(0, bin - glideBins);
+                const int last = std::min(numBins - 1, bin + glideBins);
+                for (int source = first; source <= last; ++source)
+                {
+                    const float score = scores[static_cast<size_t>(offset + source)] + logGlide[static_cast<size_t>(bin - source + glideBins)];
+                    if (score > best)
+                    {
+                        best = score;
+                        from = offset + source;
+                    }
+                }
+
+                const float switchScore = scores[static_cast<size_t>(otherOffset + bin)] + logSwitch;
+                if (switchScore > best)
+                {
+                    best = switchScore;
+                    from = otherOffset + bin;
+                }
+
+                const auto state = static_cast<size_t>(offset + bin);
+                nextScores[state] = best + observations[state];
+                frame.backPointers[state] = static_cast<int16_t>(from);
+                maxScore = std::max(maxScore, nextScores[state]);
+            }
+        }
+
+        // Keep the scores near 0 so they never underflow
+        for (auto& score : nextScores)
+            score -= maxScore;
+        scores.swap(nextScores);
+    }
+
+    /** The frame's candidate closest to a bin, or the bin's centre if no candidate is within a glide of it. */
+    float getPitchNearBin(const Frame& frame, int bin) const
+    {
+        float pitch = lowestFrequency * std::exp2(static_cast<float>(bin) * binCents / 1200.0f);
+        int closest = glideBins + 1;
+
+        for (int i = 0; i < frame.numCandidates; ++i)
+        {
+            const int distance = std::abs(getBin(frame.candidates[i].frequency) - bin);
+            if (distance < closest)
+            {
+                closest = distance;
+                pitch = frame.candidates[i].frequency;
+            }
+        }
+
+        return pitch;
+    }
+};
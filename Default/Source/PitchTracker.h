@@ -0,0 +1,530 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include "YinPitchDetector.h"
+#include "AnalysisDecimator.h"
+#include "AnalysisRingBuffer.h"
+#include "AnalysisGate.h"
+#include "InstrumentModel.h"
+#include "PitchHmm.h"
+
+/**
+ * Snapshot of the latest detection result.
+ * Written by the audio thread once per analysis frame and read by the editor through a SeqLock,
+ * so it must stay a plain, trivially copyable struct.
+ */
+struct PitchResult
+{
+    float pitch = 0.0f;  // Smoothed pitch in Hz, or 0 when nothing is being played.
+    int midiNoteNumber = -1;  // Nearest MIDI note to pitch, or -1.
+    int string = -1;  // String of the tracker's instrument, lowest first (0 = E on a 4-string), or -1.
+    int fret = -1;  // Fret on that string, or -1.
+    float confidence = 0.0f;  // Detector confidence for the latest frame, 0..1.
+    bool provisional = false;  // True while the note comes from the fast-attack window and is not yet confirmed.
+    float voicedProbability = 0.0f;  // How likely the confirmed frame is to be voiced, 0..1 (0 or 1 with the stability gate).
+};
+
+/**
+ * The complete detection pipeline, shared by the plugin and the offline tools:
+ * decimation to the analysis rate, a level gate that skips YIN on silence, hop-based framing that
+ * re-aligns to each note onset, YIN, pitch smoothing with a stability gate, and mapping of
+ * the stable pitch to a MIDI note, string and fret on the instrument given to prepare().
+ *
+ * The full window's note is confirmed by one of two NoteTracking methods: by default a pYIN-style
+ * HMM over every frame's YIN candidates, decoded a fixed number of frames behind (PitchHmm), or
+ * the original smoothing filter with a stability counter.
+ *
+ * Detection runs at two resolutions. The full window gives the confirmed note above. A short
+ * window of a couple of low-E periods (the newest samples of the same frame) gives a provisional
+ * note as soon as a new note has lasted that long, which is published with provisional = true
+ * until the full window confirms or corrects it.
+ *
+ * process() is real-time safe once prepare() has been called.
+ */
+class PitchTracker
+{
+public:
+    static constexpr float frequencyRangeMargin = 1.03f;  // Pitches tracked reach about half a semitone past the instrument's range.
+    static constexpr double minAnalysisSampleRate = 5000.0;  // Decimate no further than this.
+    static constexpr int maxAnalysisWindowSize = 4096;
+    static const int defaultRequiredStableFrames = 3;
+    static constexpr float defaultStabilityToleranceHz = 3.0f;
+    static constexpr float fastAttackPeriods = 2.0f;  // Length of the short window, in periods of the lowest pitch tracked.
+    static const int requiredProvisionalFrames = 2;  // Agreeing short-window frames before a provisional note is shown.
+    static const int probabilisticLookbackFrames = 2;  // Frames the HMM decides behind the newest one.
+
+    /** How the full window's pitches become a confirmed note. */
+    enum class NoteTracking
+    {
+        probabilistic,  // pYIN: candidates from several thresholds, decoded by an HMM with a fixed lag.
+        stabilityGate   // Single threshold, exponential smoothing and requiredStableFrames agreeing frames.
+    };
+
+    /**
+     * Builds the detector and buffers for the given input rate and instrument. windowSize and hopSize
+     * are in samples at the decimated analysis rate; the pitch range follows the instrument's lowest
+     * and highest notes. Not real-time safe.
+     */
+    void prepare(double sampleRate, int windowSize, int hopSize,
+                 const InstrumentModel::Instrument& instrumentToTrack = InstrumentModel::standardBass4)
+    {
+        instrument = instrumentToTrack;
+        minFrequency = InstrumentModel::getNoteFrequency(instrument.getLowestNote()) / frequencyRangeMargin;
+        maxFrequency = InstrumentModel::getNoteFrequency(instrument.getHighestNote()) * frequencyRangeMargin;
+
+        // Decimate to a low fixed analysis rate first; the detector works in samples at that rate, so
+        // its tau estimates convert straight back to Hz
+        decimator.prepare(sampleRate, minAnalysisSampleRate);
+        decimatedScratch.assign(static_cast<size_t>(maxDecimatorInputChunk / decimator.getFactor() + 1), 0.0f);
+
+        // The detector analyses one full analysis window per hop, regardless of the host block size
+        windowSize = std::clamp(windowSize, 64, maxAnalysisWindowSize);
+        pitchDetector = std::make_unique<YinPitchDetector>(static_cast<float>(decimator.getOutputSampleRate()), windowSize,
+                                                           minFrequency, maxFrequency);
+        pitchDetector->setDifferenceMethod(YinPitchDetector::DifferenceMethod::incremental);  // Frames overlap, so update d(tau) per hop
+        pitchDetector->setThreshold(yinThreshold);
+        pitchDetector->setProfile(profile);
+
+        // The fast-attack detector looks at the newest part of the same frame; it is only worth having
+        // if it is meaningfully shorter than the full window
+        const int shortWindowSize = static_cast<int>(std::ceil(fastAttackPeriods * decimator.getOutputSampleRate() / minFrequency)) + 2;
+        fastAttackDetector.reset();
+        if (shortWindowSize < windowSize * 3 / 4)
+        {
+            fastAttackDetector = std::make_unique<YinPitchDetector>(static_cast<float>(decimator.getOutputSampleRate()), shortWindowSize,
+                                                                    minFrequency, maxFrequency);
+            fastAttackDetector->setDifferenceMethod(YinPitchDetector::DifferenceMethod::incremental);
+            fastAttackDetector->setThreshold(yinThreshold);
+            fastAttackDetector->setProfile(profile);
+        }
+
+        hmm.prepare(minFrequency, maxFrequency, probabilisticLookbackFrames);
+        analysisBuffer.prepare(windowSize, hopSize);
+        gate.prepare(decimator.getOutputSampleRate());
+
+        // YIN needs a window filled by the new note, so frames are aligned to the point where the
+        // shortest window in use first is
+        onsetFrameDelay = fastAttackDetector != nullptr ? shortWindowSize : windowSize;
+        filterScratch.assign(static_cast<size_t>(analysisBuffer.getHopSize()), 0.0f);
+        reset();
+    }
+
+    /**
+     * Tunes detection without rebuilding anything: the YIN threshold of both detectors, how far (in
+     * Hz) a frame's pitch may move from the smoothed pitch and still count as stable, and how many
+     * stable frames confirm a note. Kept across prepare() and reset(). Real-time safe; call from the
+     * thread that runs process().
+     */
+    void setDetectionSettings(float newYinThreshold, float newStabilityToleranceHz, int newRequiredStableFrames)
+    {
+        yinThreshold = newYinThreshold;
+        stabilityToleranceHz = newStabilityToleranceHz;
+        requiredStableFrames = std::max(1, newRequiredStableFrames);
+
+        if (pitchDetector != nullptr)
+            pitchDetector->setThreshold(yinThreshold);
+        if (fastAttackDetector != nullptr)
+            fastAttackDetector->setThreshold(yinThreshold);
+    }
+
+    /**
+     * Switches between the HMM and the stability gate, forgetting the current note's history.
+     * Kept across prepare() and reset(). Real-time safe; call from the thread that runs process().
+     */
+    void setNoteTracking(NoteTracking newNoteTracking)
+    {
+        if (newNoteTracking == noteTracking)
+            return;
+
+        noteTracking = newNoteTracking;
+        hmm.reset();
+        smoothedPitch = 0.0f;
+        stableFrameCount = 0;
+        lastDecisionPitch = 0.0f;
+    }
+
+    NoteTracking getNoteTracking() const { return noteTracking; }
+
+    /**
+     * Times the detectors' steps and the note tracking into these histograms (see CpuProfiler), or
+     * stops timing if null. Kept across prepare(). Call while process() is not running.
+     */
+    void setProfile(CpuProfiler::StageTimes* newProfile)
+    {
+        profile = newProfile;
+        if (pitchDetector != nullptr)
+            pitchDetector->setProfile(profile);
+        if (fastAttackDetector != nullptr)
+            fastAttackDetector->setProfile(profile);
+    }
+
+    /** Forgets the current note and all buffered audio. */
+    void reset()
+    {
+        decimator.reset();
+        analysisBuffer.reset();
+        gate.reset();
+        hmm.reset();
+        smoothedPitch = 0.0f;  // Reset smoothed pitch
+        stableFrameCount = 0;  // Reset stable frame count
+        lastDetectedPitch = 0.0f;
+        lastDecisionPitch = 0.0f;
+        framesAnalysed = 0;
+        framesSkipped = 0;
+        samplesAnalysed = 0;
+        lastDetectionSample = -1;
+        lastOnsetSample = -1;
+        confirmationBlockedUntil = 0;
+        provisionalPitch = 0.0f;
+        provisionalFrameCount = 0;
+        result = PitchResult();
+    }
+
+    /**
+     * Decimates input samples to the analysis rate, streams them into the analysis buffer and runs
+     * the detector once for every completed hop (zero or more times per call). After an onset the hop
+     * grid is shifted so a frame lands as soon as the window holds only the new note, instead of up
+     * to a hop later. Frames that arrive while the gate is closed skip YIN and count as unvoiced.
+     * onFrame is called with the updated result after every frame.
+     */
+    template <typename FrameCallback>
+    void process(const float* samples, int numSamples, FrameCallback&& onFrame)
+    {
+        for (int inputPos = 0; inputPos < numSamples;)
+        {
+            // Decimate in bounded chunks so the scratch buffer never needs to grow
+            const int numInput = std::min(numSamples - inputPos, maxDecimatorInputChunk);
+            const int numDecimated = decimator.process(samples + inputPos, numInput, decimatedScratch.data());
+            inputPos += numInput;
+
+            for (int pos = 0; pos < numDecimated;)
+            {
+                // Never pass a frame boundary, so the scratch buffer only needs to hold one hop.
+                // The gate also stops just after an onset, so the hop grid can be re-aligned from there
+                const int available = std::min(numDecimated - pos, analysisBuffer.getSamplesUntilNextFrame());
+                const int chunk = gate.process(decimatedScratch.data() + pos, available);
+                pitchDetector->prefilter(decimatedScratch.data() + pos, filterScratch.data(), chunk);
+                pos += analysisBuffer.write(filterScratch.data(), chunk);
+                samplesAnalysed += chunk;
+
+                if (gate.lastCallFoundOnset())
+                {
+                    lastOnsetSample = samplesAnalysed;
+                    analysisBuffer.alignFrames(onsetFrameDelay);
+
+                    // Until the full window holds only the new note, it may only confirm what the short window found
+                    confirmationBlockedUntil = samplesAnalysed + analysisBuffer.getWindowSize();
+                    provisionalFrameCount = 0;
+                }
+
+                if (analysisBuffer.isFrameReady())
+                {
+                    const float* frame = analysisBuffer.getFrame();
+
+                    if (gate.isOpen())
+                    {
+                        // Tell the detector how far this frame moved on from the one it last saw (0 if none),
+                        // so it can update the difference function instead of rebuilding it
+                        const int64_t advance = lastDetectionSample < 0 ? 0 : samplesAnalysed - lastDetectionSample;
+                        const int frameAdvance = static_cast<int>(std::min<int64_t>(advance, analysisBuffer.getWindowSize()));
+                        lastDetectionSample = samplesAnalysed;
+                        lastDetectedPitch = pitchDetector->detectPitchPrefiltered(frame, frameAdvance);
+                        trackFullWindowPitch(true);
+                        result.confidence = pitchDetector->getConfidence();
+
+                        if (fastAttackDetector != nullptr)
+                        {
+                            const int shortOffset = analysisBuffer.getWindowSize() - fastAttackDetector->getBufferSize();
+                            processFastAttackPitch(fastAttackDetector->detectPitchPrefiltered(frame + shortOffset, frameAdvance));
+                        }
+                    }
+                    else
+                    {
+                        lastDetectedPitch = 0.0f;  // Silence: release the note without running YIN
+                        trackFullWindowPitch(false);
+                        processFastAttackPitch(0.0f);
+                        result.confidence = 0.0f;
+                        ++framesSkipped;
+                    }
+
+                    ++framesAnalysed;
+                    onFrame(result);
+                }
+            }
+        }
+    }
+
+    /** The current smoothed note state. */
+    const PitchResult& getResult() const { return result; }
+
+    /** Raw detector output for the most recent frame, before smoothing (0 if unvoiced). */
+    float getLastDetectedPitch() const { return lastDetectedPitch; }
+
+    /**
+     * The note tracking's own pitch after the most recent frame, before confirmation: the smoothed
+     * pitch for the stability gate, or the HMM's decision for the frame it has just settled.
+     */
+    float getTrackedPitch() const { return noteTracking == NoteTracking::stabilityGate ? smoothedPitch : lastDecisionPitch; }
+
+    /** Consecutive stable frames counted by the stability gate (0 in probabilistic mode). */
+    int getStableFrameCount() const { return stableFrameCount; }
+
+    /** Lowest CMND value of the most recent frame, or 1 if the gate was closed and YIN did not run. */
+    float getLastCmndMinimum() const
+    {
+        return lastDetectionSample >= 0 && lastDetectionSample == samplesAnalysed ? pitchDetector->getCmndMinimum() : 1.0f;
+    }
+
+    /** Time of the end of the most recent frame, in seconds since prepare() or reset(). */
+    double getFrameTimeSeconds() const
+    {
+        return static_cast<double>(samplesAnalysed) / decimator.getOutputSampleRate();
+    }
+
+    /** True while the input is loud enough to be analysed. */
+    bool isGateOpen() const { return gate.isOpen(); }
+
+    /**
+     * Input-rate sample index, counted from prepare() or reset(), of the last input sample the most
+     * recent frame had seen: when the current result was decided.
+     */
+    int64_t getFrameInputSample() const { return samplesAnalysed * decimator.getFactor(); }
+
+    /**
+     * Input-rate sample index of the most recent note onset in the input signal, corrected for the
+     * decimator's delay, or -1 if there has not been one.
+     */
+    int64_t getLastOnsetInputSample() const
+    {
+        return lastOnsetSample < 0 ? -1 : std::max<int64_t>(0, lastOnsetSample * decimator.getFactor() - decimator.getLatencySamples());
+    }
+
+    /** How hard the most recent note was played, in dB relative to full scale. */
+    float getLastOnsetLevelDb() const { return gate.getOnsetLevelDb(); }
+
+    /**
+     * Typical time, in input samples, from a note onset to the first frame that can report the note:
+     * the decimator delay, the onset-aligned window filling and the frames needed to agree.
+     */
+    int getNoteLatencyInputSamples() const
+    {
+        const int analysisSamples = fastAttackDetector != nullptr
+                                      ? onsetFrameDelay + (requiredProvisionalFrames - 1) * analysisBuffer.getHopSize()
+                                      : analysisBuffer.getWindowSize() + getConfirmationFrames() * analysisBuffer.getHopSize();
+        return analysisSamples * decimator.getFactor() + decimator.getLatencySamples();
+    }
+
+    /** Frames since prepare() or reset(), and how many of them the gate skipped. */
+    int64_t getFramesAnalysed() const { return framesAnalysed; }
+    int64_t getFramesSkipped() const { return framesSkipped; }
+
+    double getAnalysisSampleRate() const { return decimator.getOutputSampleRate(); }
+    int getWindowSize() const { return analysisBuffer.getWindowSize(); }
+    int getHopSize() const { return analysisBuffer.getHopSize(); }
+
+    const InstrumentModel::Instrument& getInstrument() const { return instrument; }
+
+    /** Converts a frequency to the nearest MIDI note number (A4 = 440 Hz = 69). */
+    static int frequencyToMidiNote(float frequency) { return InstrumentModel::frequencyToMidiNote(frequency); }
+
+private:
+    std::unique_ptr<YinPitchDetector> pitchDetector;
+    std::unique_ptr<YinPitchDetector> fastAttackDetector;  // Short window for provisional notes, or null.
+    AnalysisDecimator decimator;  // Brings the input down to the analysis rate before detection.
+    std::vector<float> decimatedScratch;  // Decimator output for one input chunk.
+    AnalysisRingBuffer analysisBuffer;  // Streams pre-filtered input into overlapping analysis frames.
+    std::vector<float> filterScratch;  // Holds up to one hop of pre-filtered input before it is buffered.
+    static constexpr int maxDecimatorInputChunk = 1024;  // Input samples decimated per pass of process().
+    AnalysisGate gate;  // Skips detection on silence and spots note onsets.
+    int onsetFrameDelay = 0;  // Samples from an onset to the frame the hop grid is aligned to.
+    InstrumentModel::Instrument instrument = InstrumentModel::standardBass4;  // Maps notes to strings and frets.
+    float minFrequency = 0.0f;  // Pitch range tracked, from the instrument's lowest and highest notes.
+    float maxFrequency = 0.0f;
+    NoteTracking noteTracking = NoteTracking::probabilistic;
+    CpuProfiler::StageTimes* profile = nullptr;  // Where stages are timed, or null.
+    PitchHmm hmm;  // Decodes the full window's candidates in probabilistic mode.
+    std::array<YinPitchDetector::PitchCandidate, YinPitchDetector::maxPitchCandidates> candidates {};
+    float yinThreshold = YinPitchDetector::defaultThreshold;
+    float stabilityToleranceHz = defaultStabilityToleranceHz;  // Largest pitch change between frames that counts as stable.
+    int requiredStableFrames = defaultRequiredStableFrames;  // Stable full-window frames before a note is confirmed.
+
+    PitchResult result;  // Current pitch, note, string and fret.
+    float smoothedPitch = 0.0f;
+    int stableFrameCount = 0;
+    float lastDetectedPitch = 0.0f;
+    float lastDecisionPitch = 0.0f;  // The HMM's latest decision, 0 if unvoiced.
+    int64_t framesAnalysed = 0;
+    int64_t framesSkipped = 0;
+    int64_t samplesAnalysed = 0;  // Analysis-rate samples streamed since prepare() or reset().
+    int64_t lastDetectionSample = -1;  // samplesAnalysed at the last frame YIN ran on, or -1.
+    int64_t lastOnsetSample = -1;  // samplesAnalysed at the latest onset, or -1.
+    int64_t confirmationBlockedUntil = 0;  // samplesAnalysed at which the full window has cleared the last onset.
+    float provisionalPitch = 0.0f;  // Latest short-window pitch, or 0.
+    int provisionalFrameCount = 0;  // Consecutive short-window frames agreeing with provisionalPitch.
+
+    /** Hops from the first frame that sees a note to the frame that can confirm it. */
+    int getConfirmationFrames() const
+    {
+        return noteTracking == NoteTracking::probabilistic ? hmm.getLookbackFrames() : requiredStableFrames - 1;
+    }
+
+    /**
+     * Passes the full window's latest frame to the selected note tracking. voicedFrame is false for
+     * frames the gate skipped, which YIN has not looked at.
+     */
+    void trackFullWindowPitch(bool voicedFrame)
+    {
+        if (noteTracking == NoteTracking::stabilityGate)
+        {
+            BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::noteTracking);
+            processDetectedPitch(lastDetectedPitch);
+            result.voicedProbability = lastDetectedPitch > 0.0f ? 1.0f : 0.0f;
+            return;
+        }
+
+        // The candidates are timed as part of the threshold step
+        const int numCandidates = voicedFrame ? pitchDetector->getPitchCandidates(candidates.data(), static_cast<int>(candidates.size())) : 0;
+
+        BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::noteTracking);
+        processDecision(hmm.processFrame(candidates.data(), numCandidates));
+    }
+
+    /**
+     * Publishes the HMM's decision for the frame it has just settled. Like the stability gate, it
+     * leaves a provisional note to the short window and respects the block after an onset.
+     */
+    void processDecision(const PitchHmm::Decision& decision)
+    {
+        result.voicedProbability = decision.voicedProbability;
+        lastDecisionPitch = decision.pitch;
+
+        if (decision.pitch > 0.0f)
+        {
+            if (canConfirm(decision.pitch))
+            {
+                result.pitch = decision.pitch;
+                updateCurrentNote(result.pitch);
+                result.provisional = false;
+            }
+        }
+        else if (! result.provisional)
+        {
+            clearNote();
+        }
+    }
+
+    /**
+     * Smooths a newly detected pitch and updates the current note once it has been stable for
+     * requiredStableFrames consecutive analysis frames.
+     */
+    void processDetectedPitch(float detectedPitch)
+    {
+        // Check if the detected pitch is within the range of the instrument
+        if (detectedPitch >= minFrequency && detectedPitch <= maxFrequency)
+        {
+            // Smooth the pitch detection to avoid jumps and update if stable
+            if (std::abs(detectedPitch - smoothedPitch) < stabilityToleranceHz || smoothedPitch == 0.0f)
+            {
+                smoothedPitch = 0.7f * smoothedPitch + 0.3f * detectedPitch;  // Apply a smoothing filter
+                stableFrameCount++;
+                if (stableFrameCount >= requiredStableFrames && canConfirm(smoothedPitch))
+                {
+                    result.pitch = smoothedPitch;  // Update the current pitch if it has been stable
+                    updateCurrentNote(result.pitch);  // Update the current note based on the pitch
+                    result.provisional = false;
+                }
+            }
+            else
+            {
+                stableFrameCount = 0;  // Reset the stability counter if the pitch is unstable
+                smoothedPitch = detectedPitch;  // Update the smoothed pitch immediately
+            }
+        }
+        else
+        {
+            stableFrameCount = 0;  // Reset the stability counter if the pitch is out of range
+            if (smoothedPitch > 0.0f)
+            {
+                smoothedPitch *= 0.9f;  // Apply a slow decay to the smoothed pitch
+                if (smoothedPitch < 0.75f * minFrequency)
+                {
+                    smoothedPitch = 0.0f;  // Reset the pitch if it decays too low
+                    if (! result.provisional)  // A provisional note is released by the short window instead
+                        clearNote();
+                }
+            }
+        }
+    }
+
+    /**
+     * True if the full window may publish this pitch: always, except shortly after an onset, when
+     * the window still holds the previous note and may only confirm what the short window found.
+     */
+    bool canConfirm(float pitch) const
+    {
+        return samplesAnalysed >= confirmationBlockedUntil || (provisionalPitch > 0.0f && isSameNote(pitch, provisionalPitch));
+    }
+
+    static bool isSameNote(float a, float b)
+    {
+        return std::abs(12.0f * std::log2(a / b)) < 0.5f;  // Within half a semitone
+    }
+
+    /**
+     * Tracks the short-window pitch and publishes it as a provisional note once requiredProvisionalFrames
+     * consecutive frames agree, as long as no confirmed note is showing (or an onset has made the
+     * confirmed one stale). A provisional note is dropped again when the short window loses it.
+     */
+    void processFastAttackPitch(float detectedPitch)
+    {
+        if (detectedPitch >= minFrequency && detectedPitch <= maxFrequency)
+        {
+            provisionalFrameCount = provisionalPitch > 0.0f && isSameNote(detectedPitch, provisionalPitch) ? provisionalFrameCount + 1 : 1;
+            provisionalPitch = detectedPitch;
+
+            const bool confirmedNoteShowing = result.midiNoteNumber >= 0 && ! result.provisional;
+            const bool confirmedNoteStale = samplesAnalysed < confirmationBlockedUntil && ! isSameNote(result.pitch, provisionalPitch);
+            if (provisionalFrameCount >= requiredProvisionalFrames && (! confirmedNoteShowing || confirmedNoteStale))
+            {
+                result.pitch = provisionalPitch;
+                updateCurrentNote(provisionalPitch);
+                result.provisional = true;
+            }
+        }
+        else
+        {
+            provisionalPitch = 0.0f;
+            provisionalFrameCount = 0;
+            if (result.provisional)
+                clearNote();
+        }
+    }
+
+    void clearNote()
+    {
+        result.pitch = 0.0f;  // Clear the current pitch
+        result.string = -1;  // Reset string index
+        result.fret = -1;  // Reset fret index
+        result.midiNoteNumber = -1;  // Reset note
+        result.provisional = false;
+    }
+
+    /**
+     * Updates the current note, string, and fret based on the detected pitch. The note comes from the
+     * model's boundary table and the position from the instrument's note table, so there is no log2.
+     */
+    void updateCurrentNote(float pitch)
+    {
+        // Pitches in the margin just outside the instrument's range snap to its lowest or highest note
+        const int note = std::clamp(frequencyToMidiNote(pitch), instrument.getLowestNote(), instrument.getHighestNote());
+        const auto position = instrument.getPosition(note);
+
+        result.midiNoteNumber = note;  // Note names are built on the GUI side
+        result.string = position.string;
+        result.fret = position.fret;
+    }
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/** One analysis frame, as the editor's pitch trail draws it. */
+struct PitchTrailPoint
+{
+    int64_t frameSample = 0;  // Input sample at the end of the frame, counted from prepareToPlay.
+    float detectedPitch = 0.0f;  // Raw full-window pitch in Hz, 0 if unvoiced.
+    float confidence = 0.0f;
+    int midiNoteNumber = -1;  // Note shown after the frame, or -1.
+    bool provisional = false;
+};
+
+/**
+ * Hands every analysis frame of one channel to the editor's pitch trail.
+ *
+ * A single-producer/single-consumer juce::AbstractFifo, as in PitchAnalysisWorker: the thread
+ * running the channel's tracker pushes each frame and the editor pops them on its vblank, with no
+ * locks or allocation on either side. While no editor is open nothing pops, so the queue fills and
+ * later points are simply dropped; an editor discards that backlog when it opens.
+ */
+class PitchTrailFifo
+{
+public:
+    static const int capacity = 1024;  // About ten seconds of frames at the default hop.
+
+    PitchTrailFifo() : points(static_cast<size_t>(capacity) + 1) {}
+
+    /** Queues a point, or drops it if the queue is full. Producer only. */
+    void push(const PitchTrailPoint& point) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            points[static_cast<size_t>(start1)] = point;
+
+        fifo.finishedWrite(size1);
+    }
+
+    /** Moves up to maxPoints queued points, oldest first, into destination. Returns how many. Consumer only. */
+    int pop(PitchTrailPoint* destination, int maxPoints) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(std::min(maxPoints, fifo.getNumReady()), start1, size1, start2, size2);
+
+        std::copy(points.begin() + start1, points.begin() + start1 + size1, destination);
+        std::copy(points.begin() + start2, points.begin() + start2 + size2, destination + size1);
+
+        fifo.finishedRead(size1 + size2);
+        return size1 + size2;
+    }
+
+    /** Drops everything queued. Consumer only. */
+    void discard() noexcept { fifo.finishedRead(fifo.getNumReady()); }
+
+private:
+    juce::AbstractFifo fifo { capacity + 1 };  // AbstractFifo keeps one slot free.
+    std::vector<PitchTrailPoint> points;  // Point storage indexed by the AbstractFifo.
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "PluginProcessor.h"
+
+/**
+ * Scrolling piano roll of every analysis frame: the shown note of each frame as a bar in its note
+ * lane (amber while provisional), and the raw detector pitch as a thin line over it, brighter the
+ * more confident the detector was.
+ *
+ * The frames come from the processor's PitchTrailFifos. Drawing is incremental: update() scrolls
+ * the trail image left by the time that has passed and draws only the frames that have arrived,
+ * so each vblank costs one image move and a few short lines however long the history is. The note
+ * lanes are drawn once into a separate background image. Both images are kept at the display's
+ * pixel scale, like the editor's static layer; a scale change or resize clears the trail.
+ */
+class PitchTrailView : public juce::Component
+{
+public:
+    static constexpr float pixelsPerSecond = 100.0f;
+    static constexpr double restartSeconds = 1.0;  // A frame this far behind the trail means the analysis was restarted.
+
+    explicit PitchTrailView(DefaultAudioProcessor& p)
+        : processor(p),
+          lowestNote(p.getInstrument().getLowestNote() - 1),
+          highestNote(p.getInstrument().getHighestNote() + 1)
+    {
+        setOpaque(true);  // paint() covers the view, so the editor behind it is not repainted
+    }
+
+    /**
+     * Takes the frames queued since the last call and draws them onto the trail, repainting the
+     * view only if there were any. Call on every vblank from the message thread.
+     */
+    void update()
+    {
+        const double sampleRate = processor.getSampleRate();
+        const bool canDraw = trail.isValid() && sampleRate > 0.0;
+
+        for (int c = 0; c < processor.getNumAnalysedChannels(); ++c)
+        {
+            auto& fifo = processor.getTrailFifo(c);
+
+            // Until the first paint there is no image to draw on, so the backlog is thrown away
+            if (! canDraw)
+            {
+                fifo.discard();
+                continue;
+            }
+
+            const int numPoints = fifo.pop(points.data(), static_cast<int>(points.size()));
+            if (numPoints > 0)
+            {
+                drawPoints(c, numPoints, sampleRate);
+                repaint();
+            }
+        }
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (! trail.isValid() || scale != imageScale)
+            createImages(scale);
+
+        g.drawImage(background, getLocalBounds().toFloat());
+        g.drawImage(trail, getLocalBounds().toFloat());
+    }
+
+    void resized() override
+    {
+        trail = {};  // Recreated at the next paint()
+        background = {};
+        repaint();
+    }
+
+    /** Shows the lanes for another instrument; the trail drawn so far is in the old lanes, so it is cleared. */
+    void setInstrument(const InstrumentModel::Instrument& instrument)
+    {
+        lowestNote = instrument.getLowestNote() - 1;
+        highestNote = instrument.getHighestNote() + 1;
+        resized();
+    }
+
+private:
+    DefaultAudioProcessor& processor;
+    int lowestNote;  // Lanes shown, a semitone beyond the processor's instrument at each end.
+    int highestNote;
+
+    juce::Image background;  // Note lanes and labels.
+    juce::Image trail;  // Transparent, scrolled as time passes.
+    float imageScale = 0.0f;  // Physical pixels per logical pixel of both images.
+    double trailEndSeconds = 0.0;  // Frame time at the trail's right edge.
+
+    /** The last frame drawn for each channel, which the next frame's line starts from. */
+    struct LastPoint
+    {
+        double seconds = -1.0;  // Negative: nothing drawn yet.
+        float notePosition = 0.0f;  // Raw pitch as a fractional MIDI note, or 0 if unvoiced.
+    };
+
+    std::array<LastPoint, DefaultAudioProcessor::maxAnalysisChannels> lastPoints {};
+    std::array<PitchTrailPoint, 256> points {};  // Frames popped in one update.
+
+    static constexpr double maxJoinSeconds = 0.1;  // Frames further apart are not joined up.
+
+    float getLaneHeight() const { return static_cast<float>(trail.getHeight()) / static_cast<float>(highestNote - lowestNote + 1); }
+
+    /** Vertical position, in trail pixels, of the centre of a (fractional) MIDI note. */
+    float getNoteY(float note) const { return (static_cast<float>(highestNote) + 0.5f - note) * getLaneHeight(); }
+
+    float getSecondsX(double seconds) const
+    {
+        return static_cast<float>(trail.getWidth()) - static_cast<float>((trailEndSeconds - seconds) * pixelsPerSecond * imageScale);
+    }
+
+    void createImages(float scale)
+    {
+        imageScale = scale;
+        const int width = juce::jmax(1, juce::roundToInt(static_cast<float>(getWidth()) * scale));
+        const int height = juce::jmax(1, juce::roundToInt(static_cast<float>(getHeight()) * scale));
+
+        // Software images, so scrolling moves the pixels in place
+        trail = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+        background = juce::Image(juce::Image::RGB, width, height, false);
+        lastPoints.fill({});
+
+        juce::Graphics g(background);
+        g.fillAll(juce::Colour(0xFF1E4A6D));
+
+        // Black-key lanes are darker, and each C has its name, as on a piano roll
+        const float laneHeight = getLaneHeight();
+        g.setFont(juce::jmin(11.0f * scale, laneHeight * 3.0f));
+        for (int note = lowestNote; note <= highestNote; ++note)
+        {
+            const float top = getNoteY(static_cast<float>(note)) - laneHeight * 0.5f;
+            const int pitchClass = InstrumentModel::getPitchClass(note);
+
+            if (pitchClass == 1 || pitchClass == 3 || pitchClass == 6 || pitchClass == 8 || pitchClass == 10)
+            {
+                g.setColour(juce::Colours::black.withAlpha(0.2f));
+                g.fillRect(0.0f, top, static_cast<float>(width), laneHeight);
+            }
+
+            if (pitchClass == 0)
+            {
+                g.setColour(juce::Colours::white.withAlpha(0.15f));
+                g.drawHorizontalLine(juce::roundToInt(top + laneHeight), 0.0f, static_cast<float>(width));
+                g.setColour(juce::Colours::white.withAlpha(0.5f));
+                g.drawText(juce::MidiMessage::getMidiNoteName(note, true, true, 4),
+                           juce::Rectangle<float>(2.0f * scale, top + laneHeight - 12.0f * scale, 40.0f * scale, 12.0f * scale),
+                           juce::Justification::bottomLeft);
+            }
+        }
+    }
+
+    /** Scrolls the trail to the newest of the popped frames and draws them all. */
+    void drawPoints(int channel, int numPoints, double sampleRate)
+    {
+        double newestSeconds = 0.0;
+        for (int i = 0; i < numPoints; ++i)
+            newestSeconds = std::max(newestSeconds, static_cast<double>(points[static_cast<size_t>(i)].frameSample) / sampleRate);
+
+        // prepareToPlay restarts the frame times; start the trail again from the new ones
+        if (newestSeconds + restartSeconds < trailEndSeconds)
+        {
+            trail.clear(trail.getBounds());
+            trailEndSeconds = newestSeconds;
+            lastPoints.fill({});
+        }
+
+        scrollTo(newestSeconds);
+
+        juce::Graphics g(trail);
+        const float laneHeight = getLaneHeight();
+        auto& last = lastPoints[static_cast<size_t>(channel)];
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto& point = points[static_cast<size_t>(i)];
+            const double seconds = static_cast<double>(point.frameSample) / sampleRate;
+            const float x = getSecondsX(seconds);
+            const bool joined = last.seconds >= 0.0 && seconds - last.seconds <= maxJoinSeconds;
+            const float startX = joined ? getSecondsX(last.seconds) : x - imageScale;
+
+            if (point.midiNoteNumber >= 0)
+            {
+                g.setColour(point.provisional ? juce::Colour(0xFFFFB300) : juce::Colour(0xFF66BB6A));
+                g.fillRect(startX, getNoteY(static_cast<float>(point.midiNoteNumber)) - laneHeight * 0.5f, x - startX, laneHeight);
+            }
+
+            const float notePosition = point.detectedPitch > 0.0f ? 69.0f + 12.0f * std::log2(point.detectedPitch / 440.0f) : 0.0f;
+            if (notePosition > 0.0f)
+            {
+                g.setColour(juce::Colours::white.withAlpha(0.3f + 0.7f * point.confidence));
+                if (joined && last.notePosition > 0.0f && std::abs(notePosition - last.notePosition) < 2.0f)
+                    g.drawLine(startX, getNoteY(last.notePosition), x, getNoteY(notePosition), imageScale);
+                else
+                    g.fillRect(x - imageScale, getNoteY(notePosition) - imageScale * 0.5f, imageScale, imageScale);
+            }
+
+            last = { seconds, notePosition };
+        }
+    }
+
+    /** Moves the trail left so its right edge is at (or just past) the given frame time, clearing the uncovered strip. */
+    void scrollTo(double seconds)
+    {
+        const int shift = static_cast<int>(std::ceil((seconds - trailEndSeconds) * pixelsPerSecond * imageScale));
+        if (shift <= 0)
+            return;
+
+        const int width = trail.getWidth();
+        if (shift < width)
+            trail.moveImageSection(0, 0, shift, 0, width - shift, trail.getHeight());
+        trail.clear({ juce::jmax(0, width - shift), 0, juce::jmin(shift, width), trail.getHeight() });
+
+        trailEndSeconds += shift / (pixelsPerSecond * imageScale);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PitchTrailView)
+};
@@ -2,10 +2,11 @@
 #include "PluginEditor.h"
 
 DefaultAudioProcessorEditor::DefaultAudioProcessorEditor(DefaultAudioProcessor& p)
-    : AudioProcessorEditor(&p), audioProcessor(p)  // Initializing the base class and storing reference to the processor
+    : AudioProcessorEditor(&p), audioProcessor(p),  // Initializing the base class and storing reference to the processor
+      instrument(p.getInstrument()), numStrings(instrument.getNumStrings())
 {
-    // Set the size of the plugin editor window (width: 860, height: 330)
-    setSize(860, 330);  // Increased height to accommodate title bar
+    // Set the size of the plugin editor window (width: 860, height: 450)
+    setSize(860, 450);  // Increased height to accommodate the title bar and the pitch trail
 
     // Add and configure the title label
     addAndMakeVisible(titleLabel);
@@ -16,16 +17,12 @@ DefaultAudioProcessorEditor::DefaultAudioProcessorEditor(DefaultAudioProcessor&
 
     // Add and configure the scale mode selector (drop-down menu)
     addAndMakeVisible(scaleModeSelector);
-    scaleModeSelector.addItem("Ionian (Major)", 1);
-    scaleModeSelector.addItem("Dorian", 2);
-    scaleModeSelector.addItem("Phrygian", 3);
-    scaleModeSelector.addItem("Lydian", 4);
-    scaleModeSelector.addItem("Mixolydian", 5);
-    scaleModeSelector.addItem("Aeolian (Natural Minor)", 6);
-    scaleModeSelector.addItem("Locrian", 7);
-    scaleModeSelector.setSelectedItemIndex(0);  // Default selection to "Ionian (Major)"
+    for (int i = 0; i < InstrumentModel::numScales; ++i)
+        scaleModeSelector.addItem(InstrumentModel::scaleNames[i], i + 1);  // Item IDs start at 1
     scaleModeSelector.setJustificationType(juce::Justification::centred);
-    scaleModeSelector.onChange = [this] { repaint(); };  // Repaint when selection changes
+    scaleModeSelector.onChange = [this] { updateHighlights(); };  // Only the note circles depend on the mode
+    scaleModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getParameters(), DefaultAudioProcessor::ParameterIDs::scale, scaleModeSelector);  // Selects the saved mode
 
     // Add and configure the mode selection label
     addAndMakeVisible(modeSelectionLabel);
@@ -37,49 +34,176 @@ DefaultAudioProcessorEditor::DefaultAudioProcessorEditor(DefaultAudioProcessor&
     liveFeedbackLabel.setText("Live Feedback", juce::dontSendNotification);
     liveFeedbackLabel.setJustificationType(juce::Justification::centred);
 
-    // Start a timer with an interval of 50 milliseconds to periodically call timerCallback()
-    startTimer(50);
+    // Add the rendering mode switch, which sits at the right of the title bar
+    addAndMakeVisible(openGLToggle);
+    openGLToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    openGLToggle.setColour(juce::ToggleButton::tickColourId, juce::Colours::white);
+    openGLToggle.onClick = [this] { setOpenGLRendering(openGLToggle.getToggleState()); };
+
+   #if BASSBUD_PROFILING
+    // The CPU overlay sits beside it
+    addAndMakeVisible(profilerToggle);
+    profilerToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    profilerToggle.setColour(juce::ToggleButton::tickColourId, juce::Colours::white);
+    profilerToggle.onClick = [this] { updateProfilerOverlay(); };
+   #endif
+
+    // The flight recording button sits at the left of the title bar
+    addAndMakeVisible(saveRecordingButton);
+    saveRecordingButton.setTooltip("Save the last few seconds of detector decisions, to look into a wrong note");
+    saveRecordingButton.onClick = [this] { chooseRecordingFile(); };
+
+    addAndMakeVisible(pitchTrail);
+
+    openGLContext.setRenderer(this);
+    openGLContext.setComponentPaintingEnabled(true);  // The context draws paint() and the child components
+
+    setOpaque(true);  // paint() covers every pixel, so nothing behind the editor needs repainting
+    debugInfoText = makeDebugInfoText();
+    updateHighlights();
+    setOpenGLRendering(audioProcessor.isOpenGLRenderingEnabled());
 }
 
 DefaultAudioProcessorEditor::~DefaultAudioProcessorEditor()
 {
-    stopTimer();  // Stop the timer to prevent further callbacks
+    openGLContext.detach();  // Stops the render thread before anything it paints is destroyed
+}
+
+/**
+ * Attaches or detaches the OpenGL context and remembers the choice in the processor.
+ */
+void DefaultAudioProcessorEditor::setOpenGLRendering(bool shouldUseOpenGL)
+{
+    audioProcessor.setOpenGLRenderingEnabled(shouldUseOpenGL);
+    openGLToggle.setToggleState(shouldUseOpenGL, juce::dontSendNotification);
+
+    if (shouldUseOpenGL == openGLRendering)
+        return;
+
+    openGLRendering = shouldUseOpenGL;
+
+    if (shouldUseOpenGL)
+    {
+        staticLayer = {};  // Still a software image, so it can go here; the render thread draws a texture in its place
+        openGLContextCreated = false;
+        openGLAttachTime = 0;  // The fallback timeout starts at the next vblank, once the editor is on screen
+        openGLContext.attachTo(*this);
+    }
+    else
+    {
+        openGLContext.detach();  // openGLContextClosing() releases the texture on the render thread
+    }
+
+    repaint();
 }
 
 void DefaultAudioProcessorEditor::paint(juce::Graphics& g)
 {
-    g.fillAll(juce::Colour(0xFF275A8A));  // Fill the background with a specific color
+    // Re-render the cached static layer after a resize, or if the editor moved to a display with a different pixel scale
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (staticLayerDirty || ! staticLayer.isValid() || scale != staticLayerScale)
+        renderStaticLayer(scale);
 
+    g.drawImage(staticLayer, getLocalBounds().toFloat());
+
+    // Only the note circles and the readout change at run time. Usually just a few circles are dirty,
+    // so skip the ones outside the clip region
+    const auto clip = g.getClipBounds();
+    for (int s = 0; s < numStrings; ++s)
+    {
+        for (int f = 0; f <= numFrets; ++f)
+        {
+            const auto highlight = highlights[static_cast<size_t>(s * (numFrets + 1) + f)];
+            if (highlight != Highlight::none && clip.intersects(getNotePlaceholderBounds(s, f)))
+                drawNotePlaceholder(g, fretboardBounds, s, f, highlight == Highlight::root, highlight == Highlight::mode);
+        }
+    }
+
+    if (clip.intersects(debugInfoBounds))
+        drawDebugInfo(g);  // Draw debug information on the bottom part of the editor
+
+    if (profilerOverlayText.isNotEmpty() && clip.intersects(profilerOverlayBounds))
+        drawProfilerOverlay(g);
+}
+
+/**
+ * Resized method for the editor.
+ * Lays out the child components and works out the drawing areas used by paint(), then marks
+ * the cached static layer.
+ */
+void DefaultAudioProcessorEditor::resized()
+{
     auto bounds = getLocalBounds().reduced(20);  // Define the drawing area with some padding
 
-    // Draw the title bar at the top
-    auto titleBounds = bounds.removeFromTop(40);
-    g.setColour(juce::Colour(0xFF1E4A6D));  // Set color for the title bar background
-    g.fillRect(titleBounds);
+    // The pitch trail runs along the bottom, below everything else
+    pitchTrail.setBounds(bounds.removeFromBottom(110));
+    bounds.removeFromBottom(10);
+
+    // The title bar at the top
+    titleBounds = bounds.removeFromTop(40);
     titleLabel.setBounds(titleBounds);  // Set the title label's bounds to match the title bar
+    openGLToggle.setBounds(titleBounds.withTrimmedLeft(titleBounds.getWidth() - 90).reduced(5));
+    profilerToggle.setBounds(openGLToggle.getBounds().translated(-80, 0).withWidth(70));
+    saveRecordingButton.setBounds(titleBounds.withWidth(90).reduced(5));
 
     bounds.removeFromTop(10);  // Add some vertical space between the title and the next section
 
     // Define the area for the mode selection drop-down menu and label
     auto modeSelectionBounds = bounds.removeFromTop(50);
     modeSelectionLabel.setBounds(modeSelectionBounds.removeFromTop(20));  // Set label bounds
+    selectorBounds = modeSelectionBounds.reduced(static_cast<int>(modeSelectionBounds.getWidth() * 0.3), 0);
+    scaleModeSelector.setBounds(selectorBounds);
 
-    // Add a shadow effect to the drop-down menu
-    juce::DropShadow dropShadow(juce::Colours::black.withAlpha(0.5f), 5, juce::Point<int>(0, 2));
-    dropShadow.drawForRectangle(g, modeSelectionBounds.reduced(static_cast<int>(modeSelectionBounds.getWidth() * 0.3), 0));
-    scaleModeSelector.setBounds(modeSelectionBounds.reduced(static_cast<int>(modeSelectionBounds.getWidth() * 0.3), 0));
+    // The CPU overlay uses the free space left of the selector, over the labels' empty left side
+    profilerOverlayBounds = juce::Rectangle<int>(bounds.getX(), modeSelectionBounds.getY() - 20,
+                                                 selectorBounds.getX() - bounds.getX() - 10, 80);
 
     bounds.removeFromTop(10);  // Add vertical space between the drop-down and the next section
     liveFeedbackLabel.setBounds(bounds.removeFromTop(20));  // Set bounds for the live feedback label
     bounds.removeFromTop(10);  // Add more vertical space
 
     // Define the area for drawing the fretboard
-    auto fretboardBounds = bounds.removeFromTop(static_cast<int>(bounds.getHeight() * 0.7));
+    fretboardBounds = bounds.removeFromTop(static_cast<int>(bounds.getHeight() * 0.7));
     int fretboardWidth = static_cast<int>(fretboardBounds.getWidth() * 0.8);
     fretboardBounds = fretboardBounds.withSizeKeepingCentre(fretboardWidth, fretboardBounds.getHeight());
     int extraTopSpace = static_cast<int>(fretboardBounds.getHeight() * 0.1);
     fretboardBounds = fretboardBounds.withTrimmedTop(-extraTopSpace);
 
+    debugInfoBounds = bounds.removeFromBottom(30);  // The debug readout sits at the bottom, centred
+
+    staticLayerDirty = true;  // Redrawn by the next paint(), on the thread that owns the image
+    repaint();
+}
+
+/**
+ * Draws everything that does not depend on the detected note into staticLayer, at the given
+ * physical pixel scale so the cached image stays sharp on high-DPI displays. When called on the
+ * OpenGL render thread the image is a texture, so drawing it each frame stays on the GPU.
+ */
+void DefaultAudioProcessorEditor::renderStaticLayer(float scale)
+{
+    staticLayerScale = scale;
+    staticLayerDirty = false;
+    const int width = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    const int height = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+
+    if (juce::OpenGLContext::getCurrentContext() != nullptr)
+        staticLayer = juce::Image(juce::Image::ARGB, width, height, false, juce::OpenGLImageType());
+    else
+        staticLayer = juce::Image(juce::Image::RGB, width, height, false);
+
+    juce::Graphics g(staticLayer);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
+    g.fillAll(juce::Colour(0xFF275A8A));  // Fill the background with a specific color
+
+    g.setColour(juce::Colour(0xFF1E4A6D));  // Set color for the title bar background
+    g.fillRect(titleBounds);
+
+    // Add a shadow effect to the drop-down menu
+    juce::DropShadow dropShadow(juce::Colours::black.withAlpha(0.5f), 5, juce::Point<int>(0, 2));
+    dropShadow.drawForRectangle(g, selectorBounds);
+
     // Add a shadow effect to the fretboard
     juce::DropShadow fretboardShadow(juce::Colours::black.withAlpha(0.5f), 10, juce::Point<int>(5, 5));
     fretboardShadow.drawForRectangle(g, fretboardBounds);
@@ -103,67 +227,71 @@ void DefaultAudioProcessorEditor::paint(juce::Graphics& g)
     {
         drawFretMarker(g, fretboardBounds, i);
     }
+}
 
-    // Get the current note and the selected mode index from the scale mode selector
-    juce::String currentNote = audioProcessor.getCurrentNote();
-    int selectedMode = scaleModeSelector.getSelectedItemIndex();
+/**
+ * Works out which positions show a root (yellow) or mode (red) circle for the displayed note and
+ * the selected mode, and repaints just the circles that changed. Roots share the note's pitch class
+ * and mode notes are in the scale's pitch-class mask, so each position is one bit test.
+ */
+void DefaultAudioProcessorEditor::updateHighlights()
+{
+    const bool hasNote = displayedResult.midiNoteNumber >= 0;
+    const int rootPitchClass = hasNote ? InstrumentModel::getPitchClass(displayedResult.midiNoteNumber) : 0;
+    const auto scale = static_cast<InstrumentModel::Scale>(juce::jmax(0, scaleModeSelector.getSelectedItemIndex()));
+    const uint16_t scaleMask = hasNote ? InstrumentModel::getScaleMask(scale, rootPitchClass) : 0;
 
-    // First pass: Draw root notes (yellow)
-    for (int s = 0; s < numStrings; ++s)
+    for (int row = 0; row < numStrings; ++row)
     {
         for (int f = 0; f <= numFrets; ++f)
         {
-            juce::String noteAtPosition = getNoteAtPosition(s, f);
-            bool isRoot = isNoteMatch(currentNote, noteAtPosition);
+            const int pitchClass = instrument.getPitchClassAt(getStringForRow(row), f);
+            auto highlight = Highlight::none;
+
+            if (hasNote && pitchClass == rootPitchClass)
+                highlight = Highlight::root;
+            else if (InstrumentModel::isInScale(scaleMask, pitchClass))
+                highlight = Highlight::mode;
 
-            if (isRoot)
+            auto& current = highlights[static_cast<size_t>(row * (numFrets + 1) + f)];
+            if (current != highlight)
             {
-                drawNotePlaceholder(g, fretboardBounds, s, f, true, false);  // Draw yellow circle for root notes
+                current = highlight;
+                repaint(getNotePlaceholderBounds(row, f));
             }
         }
     }
+}
 
-    // Second pass: Draw mode notes (red) relative to the root notes
-    for (int s = 0; s < numStrings; ++s)
-    {
-        for (int f = 0; f <= numFrets; ++f)
-        {
-            juce::String noteAtPosition = getNoteAtPosition(s, f);
-            bool isRoot = isNoteMatch(currentNote, noteAtPosition);
+/**
+ * Takes the processor's new instrument after the instrument parameter changed while the editor is
+ * open: the string count moves every row, so the fretboard, the note circles and the pitch trail's
+ * note lanes are all rebuilt.
+ */
+void DefaultAudioProcessorEditor::instrumentChanged()
+{
+    instrument = audioProcessor.getInstrument();
+    numStrings = instrument.getNumStrings();
 
-            if (isRoot)
-            {
-                // For each root note, draw the corresponding mode notes
-                for (int ms = 0; ms < numStrings; ++ms)
-                {
-                    for (int mf = 0; mf <= numFrets; ++mf)
-                    {
-                        juce::String modeNoteAtPosition = getNoteAtPosition(ms, mf);
-                        bool isInMode = isNoteInMode(modeNoteAtPosition, noteAtPosition, selectedMode);
-
-                        if (isInMode && !isNoteMatch(noteAtPosition, modeNoteAtPosition))
-                        {
-                            drawNotePlaceholder(g, fretboardBounds, ms, mf, false, true);  // Draw red circle for mode notes
-                        }
-                    }
-                }
-            }
-        }
-    }
+    highlights.fill(Highlight::none);
+    updateHighlights();
+    pitchTrail.setInstrument(instrument);
 
-    drawDebugInfo(g, bounds);  // Draw debug information on the bottom part of the editor
+    staticLayerDirty = true;
+    repaint();
 }
 
 /**
- * Resized method for the editor.
- * This is called when the editor window is resized and is used to layout subcomponents.
+ * The area covered by the note circle at a position, as drawn by drawNotePlaceholder().
  */
-void DefaultAudioProcessorEditor::resized()
+juce::Rectangle<int> DefaultAudioProcessorEditor::getNotePlaceholderBounds(int stringIndex, int fretIndex) const
 {
-    auto bounds = getLocalBounds().reduced(20);  // Define the drawing area with padding
-    bounds.removeFromTop(100);  // Reserve space for the title, mode selection, and live feedback labels
-    auto fretboardBounds = bounds.removeFromTop(static_cast<int>(bounds.getHeight() * 0.7));  // Define the fretboard area
-    bounds.removeFromTop(10);  // Add some vertical space for the bottom section
+    float fretWidth = static_cast<float>(fretboardBounds.getWidth()) / numFrets;
+    float stringSpacing = fretboardBounds.getHeight() / (numStrings + 1);
+    float noteX = static_cast<float>(fretboardBounds.getX()) + (fretIndex + 0.5f) * fretWidth;
+    float noteY = static_cast<float>(fretboardBounds.getY()) + (stringIndex + 1) * stringSpacing;
+
+    return juce::Rectangle<float>(noteX - 12, noteY - 12, 24, 24).getSmallestIntegerContainer().expanded(1);  // Allow for anti-aliasing
 }
 
 /**
@@ -235,107 +363,176 @@ void DefaultAudioProcessorEditor::drawNotePlaceholder(juce::Graphics& g, juce::R
     }
 }
 
-void DefaultAudioProcessorEditor::drawDebugInfo(juce::Graphics& g, juce::Rectangle<int> bounds)
+void DefaultAudioProcessorEditor::drawDebugInfo(juce::Graphics& g)
 {
     g.setColour(juce::Colours::white);  // Set color for the debug text (white)
     g.setFont(30.0f);  // Set a larger font size for the debug text
 
-    juce::String debugInfo = "Note: " + audioProcessor.getCurrentNote() +
-                             "  Frequency: " + juce::String(audioProcessor.getCurrentPitch(), 2) + " Hz";  // Construct the debug string
-
-    g.drawFittedText(debugInfo, bounds.removeFromBottom(30), juce::Justification::centred, 1);  // Draw the debug information at the bottom, centered
+    g.drawFittedText(debugInfoText, debugInfoBounds, juce::Justification::centred, 1);  // Draw the debug information at the bottom, centered
 }
 
-void DefaultAudioProcessorEditor::timerCallback()
+void DefaultAudioProcessorEditor::drawProfilerOverlay(juce::Graphics& g)
 {
-    repaint();  // Repaint the editor to reflect any changes
+    g.setColour(juce::Colours::black.withAlpha(0.6f));
+    g.fillRoundedRectangle(profilerOverlayBounds.toFloat(), 4.0f);
+
+    g.setColour(juce::Colours::white);
+    g.setFont(12.0f);
+    g.drawFittedText(profilerOverlayText, profilerOverlayBounds.reduced(6, 4), juce::Justification::topLeft, 4);
 }
 
 /**
- * Checks if two notes are a match (ignoring octaves).
- * This is used to identify root notes.
+ * Saves the flight recording to a file the user picks. The snapshot is taken straight away, so the
+ * time spent in the dialog does not push the moment being reported out of the recorder's ring. A
+ * failed save is reported in a warning box, which the writing thread hands to the message thread.
  */
-bool DefaultAudioProcessorEditor::isNoteMatch(const juce::String& currentNote, const juce::String& compareNote)
+void DefaultAudioProcessorEditor::chooseRecordingFile()
 {
-    juce::String currentNoteName = currentNote.substring(0, currentNote.length() - 1);  // Extract the note name (without octave)
-    juce::String compareNoteName = compareNote.substring(0, compareNote.length() - 1);  // Extract the note name (without octave)
-
-    return currentNoteName == compareNoteName;  // Return true if the names match
+    auto recording = std::make_shared<const FlightRecorder::Recording>(audioProcessor.getFlightRecording());
+    const auto name = "BassBud " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + FlightRecorder::fileExtension;
+    recordingChooser = std::make_unique<juce::FileChooser>("Save Flight Recording",
+                                                           juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile(name),
+                                                           juce::String("*") + FlightRecorder::fileExtension);
+
+    recordingChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                      | juce::FileBrowserComponent::warnAboutOverwriting,
+                                  [recording] (const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        if (file != juce::File())
+            FlightRecorder::saveAsync(recording, file, [] (const juce::String& error)
+            {
+                juce::MessageManager::callAsync([error]
+                {
+                    juce::AlertWindow::showAsync(juce::MessageBoxOptions::makeOptionsOk(juce::MessageBoxIconType::WarningIcon,
+                                                                                        "Flight Recording Not Saved", error),
+                                                 nullptr);
+                });
+            });
+    });
 }
 
 /**
- * Checks if a note belongs to the selected mode relative to the root note.
+ * Refreshes the overlay's figures, or removes it when the CPU toggle is off.
  */
-bool DefaultAudioProcessorEditor::isNoteInMode(const juce::String& note, const juce::String& root, int modeIndex)
+void DefaultAudioProcessorEditor::updateProfilerOverlay()
 {
-    static const int modeIntervals[7][7] = {
-        {0, 2, 4, 5, 7, 9, 11},  // Ionian (Major)
-        {0, 2, 3, 5, 7, 9, 10},  // Dorian
-        {0, 1, 3, 5, 7, 8, 10},  // Phrygian
-        {0, 2, 4, 6, 7, 9, 11},  // Lydian
-        {0, 2, 4, 5, 7, 9, 10},  // Mixolydian
-        {0, 2, 3, 5, 7, 8, 10},  // Aeolian (Natural Minor)
-        {0, 1, 3, 5, 6, 8, 10}   // Locrian
-    };  // Mode intervals in semitones relative to the root note
-
-    juce::String rootNoteName = root.substring(0, root.length() - 1);  // Extract root note name
-    juce::String noteToCheck = note.substring(0, note.length() - 1);  // Extract note name to check
-
-    static const juce::String noteNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};  // Note names
-    int rootIndex = -1;
-    int noteIndex = -1;
-
-    for (int i = 0; i < 12; ++i)
-    {
-        if (noteNames[i] == rootNoteName) rootIndex = i;  // Find the index of the root note
-        if (noteNames[i] == noteToCheck) noteIndex = i;  // Find the index of the note to check
-    }
-
-    if (rootIndex == -1 || noteIndex == -1) return false;  // If either note is not found, return false
-
-    int interval = (noteIndex - rootIndex + 12) % 12;  // Calculate the interval in semitones between the root and the note
+    auto text = profilerToggle.getToggleState() ? makeProfilerOverlayText() : juce::String();
+    lastProfilerUpdate = juce::Time::getMillisecondCounter();
 
-    for (int i = 0; i < 7; ++i)
+    if (text != profilerOverlayText)
     {
-        if (modeIntervals[modeIndex][i] == interval) return true;  // Check if the interval matches any interval in the selected mode
+        profilerOverlayText = text;
+        repaint(profilerOverlayBounds);
     }
-
-    return false;  // Return false if the note is not in the mode
 }
 
 /**
- * Returns the note corresponding to an open string on the bass guitar.
- * 
- * @param stringIndex The index of the string (0 = highest string, 3 = lowest string).
- * @return The note name (including octave) for the open string.
+ * Summarises the processor's profile: the callback's cost against its deadline, and the mean
+ * time per detector call of each YIN step and of the note tracking.
  */
-juce::String DefaultAudioProcessorEditor::getOpenStringNote(int stringIndex)
+juce::String DefaultAudioProcessorEditor::makeProfilerOverlayText() const
 {
-    const juce::String openStringNotes[] = {"G3", "D3", "A2", "E2"};  // Note names for open strings on a standard-tuned bass guitar
-    return openStringNotes[stringIndex];  // Return the note for the given string
+    const auto microseconds = [this] (CpuProfiler::Stage stage)
+    {
+        return juce::String(audioProcessor.getProfileSummary(stage).getMeanNanoseconds() / 1000.0, 1);
+    };
+
+    const auto block = audioProcessor.getProfileSummary(CpuProfiler::Stage::processBlock);
+    const auto toMicroseconds = [] (int64_t ns) { return juce::String(static_cast<double>(ns) / 1000.0, 1); };
+
+    juce::String text;
+    text << "Block: " << toMicroseconds(static_cast<int64_t>(block.getMeanNanoseconds())) << " us mean, "
+         << toMicroseconds(block.getPercentileNanoseconds(0.99)) << " us p99\n"
+         << "Peak load " << juce::String(audioProcessor.getPeakBlockLoad() * 100.0f, 1) << "%, "
+         << static_cast<juce::int64>(audioProcessor.getDeadlineMissCount()) << " of "
+         << static_cast<juce::int64>(audioProcessor.getProfiledBlockCount()) << " blocks over "
+         << juce::roundToInt(audioProcessor.getDeadlineFraction() * 100.0f) << "%\n"
+         << "YIN us: diff " << microseconds(CpuProfiler::Stage::difference)
+         << ", cmnd " << microseconds(CpuProfiler::Stage::cmnd)
+         << ", thr " << microseconds(CpuProfiler::Stage::threshold) << "\n"
+         << "Tracking " << microseconds(CpuProfiler::Stage::noteTracking)
+         << " us, prefilter " << microseconds(CpuProfiler::Stage::prefilter) << " us";
+    return text;
+}
+
+juce::String DefaultAudioProcessorEditor::makeDebugInfoText() const
+{
+    juce::String debugInfo = "Note: " + midiNoteToName(displayedResult.midiNoteNumber) +
+                             "  Frequency: " + juce::String(displayedResult.pitch, 2) + " Hz";  // Construct the debug string
+    if (displayedResult.provisional)
+        debugInfo << " (provisional)";  // Fast-attack estimate, not yet confirmed by the full window
+
+    return debugInfo;
 }
 
 /**
- * Returns the note at a specific position on the fretboard.
+ * Called once per display refresh. Picks up a change of instrument, then takes a snapshot of the
+ * latest result and repaints only what it changed: the note circles when the note changes, and the
+ * readout when a field it shows does.
  */
-juce::String DefaultAudioProcessorEditor::getNoteAtPosition(int stringIndex, int fretIndex)
+void DefaultAudioProcessorEditor::vBlankCallback()
 {
-    const juce::String notes[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};  // All possible note names
-    const juce::String openStringNotes[] = {"G", "D", "A", "E"};  // Note names for open strings
+    // Fall back to software rendering if the OpenGL context has not come up in time
+    if (openGLRendering && ! openGLContextCreated)
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+        if (openGLAttachTime == 0)
+            openGLAttachTime = now;
+        else if (now - openGLAttachTime > openGLFallbackMs)
+            setOpenGLRendering(false);
+    }
+
+    if (audioProcessor.getInstrument() != instrument)
+        instrumentChanged();
+
+    const auto latest = audioProcessor.getLatestResult();  // Take one consistent snapshot per frame
+    const bool noteChanged = latest.midiNoteNumber != displayedResult.midiNoteNumber;
+    const bool readoutChanged = noteChanged
+                             || latest.provisional != displayedResult.provisional
+                             || juce::roundToInt(latest.pitch * 100.0f) != juce::roundToInt(displayedResult.pitch * 100.0f);  // The readout shows hundredths of a hertz
+    displayedResult = latest;
+
+    if (noteChanged)
+        updateHighlights();
 
-    int noteIndex = 0;
-    for (int i = 0; i < 12; ++i)
+    // The text is only rebuilt when a field it shows has changed, so a held note allocates nothing
+    if (readoutChanged)
     {
-        if (notes[i] == openStringNotes[stringIndex])
-        {
-            noteIndex = i;  // Find the index of the open string note in the notes array
-            break;
-        }
+        debugInfoText = makeDebugInfoText();
+        repaint(debugInfoBounds);
     }
 
-    noteIndex = (noteIndex + fretIndex) % 12;  // Calculate the note index at the given fret
+    if (profilerOverlayText.isNotEmpty() && juce::Time::getMillisecondCounter() - lastProfilerUpdate >= profilerUpdateMs)
+        updateProfilerOverlay();
 
-    int octave = 2 + (stringIndex >= 2 ? 1 : 0) + (noteIndex + fretIndex) / 12;  // Calculate the octave of the note
+    pitchTrail.update();  // Draws the frames analysed since the last vblank
+}
+
+void DefaultAudioProcessorEditor::newOpenGLContextCreated()
+{
+    openGLContextCreated = true;
+}
+
+void DefaultAudioProcessorEditor::renderOpenGL()
+{
+    // paint() covers the whole editor, so the frame only needs clearing before the components are drawn
+    juce::OpenGLHelpers::clear(juce::Colour(0xFF275A8A));
+}
+
+void DefaultAudioProcessorEditor::openGLContextClosing()
+{
+    staticLayer = {};  // A texture-backed image must be released while its context is still active
+}
+
+/**
+ * Converts a MIDI note number to a note name with octave (e.g. 28 -> "E1"), or "---" if there is no note.
+ * Note names are only ever built here on the message thread, never by the processor.
+ */
+juce::String DefaultAudioProcessorEditor::midiNoteToName(int midiNoteNumber)
+{
+    if (midiNoteNumber < 0)
+        return "---";
 
-    return notes[noteIndex] + juce::String(octave);  // Return the note name with the correct octave
+    return juce::MidiMessage::getMidiNoteName(midiNoteNumber, true, true, 4);  // Sharps, with octave, middle C = C4
 }
@@ -2,8 +2,13 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "PitchTrailView.h"
+#include <array>
+#include <atomic>
+#include <memory>
 
-class DefaultAudioProcessorEditor  : public juce::AudioProcessorEditor, private juce::Timer
+class DefaultAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                     private juce::OpenGLRenderer
 {
 public:
     DefaultAudioProcessorEditor (DefaultAudioProcessor&);
@@ -12,30 +17,90 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    /**
+     * Switches between the software renderer and an attached OpenGL context, which rasterises the
+     * editor on its own thread. If no context has been created shortly after switching on, the
+     * editor falls back to software rendering.
+     */
+    void setOpenGLRendering(bool shouldUseOpenGL);
+    bool isUsingOpenGL() const { return openGLRendering; }
+
 private:
     DefaultAudioProcessor& audioProcessor;
+    PitchResult displayedResult;  // Snapshot of the processor's result taken on each vblank
+    InstrumentModel::Instrument instrument;  // The processor's instrument as of the last vblank
 
     juce::Label titleLabel;
     juce::ComboBox scaleModeSelector;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> scaleModeAttachment;  // Ties the selector to the scale parameter
     juce::Label modeSelectionLabel;
     juce::Label liveFeedbackLabel;
+    juce::ToggleButton openGLToggle { "OpenGL" };
+    juce::ToggleButton profilerToggle { "CPU" };  // Shows the profiling overlay; only present when profiling is built in
+    juce::TextButton saveRecordingButton { "Save Log" };  // Saves the processor's flight recording
+    PitchTrailView pitchTrail { audioProcessor };  // Every analysis frame, scrolling along the bottom
+    std::unique_ptr<juce::FileChooser> recordingChooser;  // Kept alive while its dialog is open
     
-    static const int numStrings = 4;
-    static const int numFrets = 7;
-    
+    int numStrings;  // Drawn highest string first, so row 0 is the top string
+    static const int numFrets = 7;  // Frets shown, counting from the nut
+    static const int numPositions = InstrumentModel::Instrument::maxStrings * (numFrets + 1);
+
+    // Layout, worked out in resized() and only read by paint()
+    juce::Rectangle<int> titleBounds;
+    juce::Rectangle<int> selectorBounds;
+    juce::Rectangle<int> fretboardBounds;
+    juce::Rectangle<int> debugInfoBounds;
+    juce::Rectangle<int> profilerOverlayBounds;
+
+    // Everything that does not depend on the detected note (background, shadows, fretboard) is drawn
+    // once into this image at the display's pixel scale, and redrawn only after a resize or a scale change.
+    // With OpenGL on it is a texture, so it is only ever replaced by paint() or released by openGLContextClosing()
+    juce::Image staticLayer;
+    float staticLayerScale = 0.0f;
+    bool staticLayerDirty = false;  // Set by resized() for the next paint() to redraw the layer
+
+    enum class Highlight : uint8_t { none, root, mode };
+    std::array<Highlight, numPositions> highlights {};  // What is drawn at each string/fret position
+    juce::String debugInfoText;  // What drawDebugInfo() currently shows
+    juce::String profilerOverlayText;  // What drawProfilerOverlay() shows; empty while the overlay is off
+    juce::uint32 lastProfilerUpdate = 0;
+    static constexpr juce::uint32 profilerUpdateMs = 500;  // The figures are averages, so a slow refresh is enough
+
+    // With OpenGL on, paint() runs on the context's render thread while it holds the message manager
+    // lock, so it may read the editor state above as before
+    juce::OpenGLContext openGLContext;
+    bool openGLRendering = false;
+    std::atomic<bool> openGLContextCreated { false };  // Set by the render thread once the context exists
+    juce::uint32 openGLAttachTime = 0;  // When the context was attached, for the fallback timeout
+    static constexpr juce::uint32 openGLFallbackMs = 1000;
+
+    juce::VBlankAttachment vBlankAttachment { this, [this] { vBlankCallback(); } };
+
+    void renderStaticLayer(float scale);
+    void updateHighlights();
+    void instrumentChanged();
+    juce::Rectangle<int> getNotePlaceholderBounds(int stringIndex, int fretIndex) const;
+    juce::String makeDebugInfoText() const;
+    juce::String makeProfilerOverlayText() const;
+    void updateProfilerOverlay();
+    void chooseRecordingFile();
+
     void drawFretboard(juce::Graphics& g, juce::Rectangle<int> bounds);
     void drawString(juce::Graphics& g, juce::Rectangle<int> bounds, int stringIndex);
     void drawFret(juce::Graphics& g, juce::Rectangle<int> bounds, int fretIndex);
     void drawFretMarker(juce::Graphics& g, juce::Rectangle<int> bounds, int fretIndex);
     void drawNotePlaceholder(juce::Graphics& g, juce::Rectangle<int> bounds, int stringIndex, int fretIndex, bool isRoot, bool isInMode);
-    void drawDebugInfo(juce::Graphics& g, juce::Rectangle<int> bounds);
+    void drawDebugInfo(juce::Graphics& g);
+    void drawProfilerOverlay(juce::Graphics& g);
+
+    int getStringForRow(int row) const { return numStrings - 1 - row; }  // Rows count down from the highest string
+    static juce::String midiNoteToName(int midiNoteNumber);
 
-    bool isNoteMatch(const juce::String& currentNote, const juce::String& compareNote);
-    bool isNoteInMode(const juce::String& note, const juce::String& root, int modeIndex);
-    juce::String getOpenStringNote(int stringIndex);
-    juce::String getNoteAtPosition(int stringIndex, int fretIndex);
+    void vBlankCallback();
 
-    void timerCallback() override;
+    void newOpenGLContextCreated() override;
+    void renderOpenGL() override;
+    void openGLContextClosing() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DefaultAudioProcessorEditor)
 };
\ No newline at end of file
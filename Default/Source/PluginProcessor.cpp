@@ -12,13 +12,69 @@ DefaultAudioProcessor::DefaultAudioProcessor()
                      #endif
                        )
 #endif
-    , currentPitch(0.0f), currentString(-1), currentFret(-1), currentNote("---"),
-      smoothedPitch(0.0f), stableFrameCount(0)  // Initialize pitch detection and note-related variables
+    , parameters(*this, nullptr, "BassBud", createParameterLayout())
 {
+    instrumentParameter = parameters.getRawParameterValue(ParameterIDs::instrument);
+    windowSizeParameter = parameters.getRawParameterValue(ParameterIDs::windowSize);
+    hopSizeParameter = parameters.getRawParameterValue(ParameterIDs::hopSize);
+    noteTrackingParameter = parameters.getRawParameterValue(ParameterIDs::noteTracking);
+    yinThresholdParameter = parameters.getRawParameterValue(ParameterIDs::yinThreshold);
+    stabilityToleranceParameter = parameters.getRawParameterValue(ParameterIDs::stabilityTolerance);
+    stableFramesParameter = parameters.getRawParameterValue(ParameterIDs::stableFrames);
+    backgroundAnalysisParameter = parameters.getRawParameterValue(ParameterIDs::backgroundAnalysis);
+    midiOutputParameter = parameters.getRawParameterValue(ParameterIDs::midiOutput);
+
+    // These settings change the buffers, threads or latency, so they need the analysis rebuilt
+    for (auto* id : { ParameterIDs::instrument, ParameterIDs::windowSize, ParameterIDs::hopSize,
+                      ParameterIDs::backgroundAnalysis, ParameterIDs::midiOutput })
+        parameters.addParameterListener(id, this);
 }
 
 DefaultAudioProcessor::~DefaultAudioProcessor()
 {
+    cancelPendingUpdate();
+    stopAnalysisWorkers();  // Make sure no worker is using a detector while it is destroyed
+}
+
+/**
+ * Defines every parameter. The detector defaults are the values the pipeline was tuned with.
+ */
+juce::AudioProcessorValueTreeState::ParameterLayout DefaultAudioProcessor::createParameterLayout()
+{
+    juce::StringArray scaleNames, instrumentNames, windowSizeNames, hopSizeNames;
+    for (auto* name : InstrumentModel::scaleNames)
+        scaleNames.add(name);
+    for (auto* name : InstrumentModel::presetNames)
+        instrumentNames.add(name);
+    for (int size : windowSizeChoices)
+        windowSizeNames.add(juce::String(size));
+    for (int size : hopSizeChoices)
+        hopSizeNames.add(juce::String(size));
+
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParameterIDs::scale, 1 }, "Scale Mode", scaleNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParameterIDs::instrument, 1 }, "Instrument", instrumentNames, 0));
+
+    // Longer windows reach lower and are steadier; shorter hops react sooner. Both cost CPU
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParameterIDs::windowSize, 1 }, "Analysis Window", windowSizeNames, 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParameterIDs::hopSize, 1 }, "Analysis Hop", hopSizeNames, 1));
+
+    // Choice indices follow PitchTracker::NoteTracking. The stability settings only affect the stability gate
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParameterIDs::noteTracking, 1 }, "Note Tracking",
+                                                            juce::StringArray { "Probabilistic (pYIN)", "Stability Gate" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { ParameterIDs::yinThreshold, 1 }, "Detection Threshold",
+                                                           juce::NormalisableRange<float>(0.01f, 0.3f, 0.001f, 0.5f),
+                                                           YinPitchDetector::defaultThreshold));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { ParameterIDs::stabilityTolerance, 1 }, "Stability Tolerance",
+                                                           juce::NormalisableRange<float>(0.5f, 10.0f, 0.1f),
+                                                           PitchTracker::defaultStabilityToleranceHz,
+                                                           juce::AudioParameterFloatAttributes().withLabel("Hz")));
+    layout.add(std::make_unique<juce::AudioParameterInt>(juce::ParameterID { ParameterIDs::stableFrames, 1 }, "Stable Frames",
+                                                         1, 8, PitchTracker::defaultRequiredStableFrames));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID { ParameterIDs::backgroundAnalysis, 1 }, "Background Analysis", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID { ParameterIDs::midiOutput, 1 }, "MIDI Output", false));
+    return layout;
 }
 
 const juce::String DefaultAudioProcessor::getName() const
@@ -98,16 +154,167 @@ void DefaultAudioProcessor::changeProgramName(int index, const juce::String& new
  */
 void DefaultAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Use a larger buffer size for better low-frequency detection
-    int pitchDetectorBufferSize = std::max(1024, samplesPerBlock);
-    pitchDetector = std::make_unique<YinPitchDetector>(static_cast<float>(sampleRate), pitchDetectorBufferSize);
-    smoothedPitch = 0.0f;  // Reset smoothed pitch
-    stableFrameCount = 0;  // Reset stable frame count
+    stopAnalysisWorkers();  // The workers must not touch the detectors while they are rebuilt
+
+    instrument = getSelectedInstrument();
+    analysisWindowSize = getSelectedWindowSize();
+    analysisHopSize = getSelectedHopSize();
+
+    // One tracker per input channel. When there is one channel per string, each tracker is given
+    // just its own string, which narrows its pitch range (and so the lags YIN searches) to that string
+    const int numInputs = juce::jlimit(1, maxAnalysisChannels, getTotalNumInputChannels());
+    perStringAnalysis = numInputs > 2 && numInputs == instrument.getNumStrings();
+
+    for (int c = 0; c < numInputs; ++c)
+    {
+        auto& channel = channels[static_cast<size_t>(c)];
+        channel.stringIndex = perStringAnalysis ? c : -1;
+
+        // Analysis runs on a fixed hop, independent of the host block size
+        if (perStringAnalysis)
+            channel.tracker.prepare(sampleRate, analysisWindowSize, analysisHopSize,
+                                    InstrumentModel::Instrument({ instrument.getOpenStringNote(c) }, instrument.getNumFrets()));
+        else
+            channel.tracker.prepare(sampleRate, analysisWindowSize, analysisHopSize, instrument);
+
+        applyDetectionSettings(channel.tracker);
+        channel.tracker.setProfile(&channel.analysisTimes);
+        channel.publishedResult.store(channel.tracker.getResult());
+    }
+    numAnalysedChannels.store(numInputs);
+    inputSamplesProcessed = 0;
+    clearProfile();
+
+    // Frame times restart here, so older decisions would no longer line up
+    for (auto& channel : channels)
+        channel.recorder.clear();
+    lastBlockSize.store(0);
+    lastBlockMicroseconds.store(0.0f);
+
+    // MIDI notes are placed a fixed latency after their onsets; the audio is delayed by the same
+    // amount so it stays aligned with them once the host compensates
+    midiOutputActive = midiOutputParameter->load() >= 0.5f;
+    int latency = 0;
+    if (midiOutputActive)
+    {
+        for (int c = 0; c < numInputs; ++c)
+            latency = juce::jmax(latency, channels[static_cast<size_t>(c)].tracker.getNoteLatencyInputSamples());
+
+        // One note stream from the first input on MIDI channel 1, or one per string on channels 1-6
+        for (int c = 0; c < numInputs; ++c)
+            channels[static_cast<size_t>(c)].midiOutput.prepare(c + 1, latency);
+    }
+
+    for (int c = 0; c < maxAnalysisChannels; ++c)
+        channels[static_cast<size_t>(c)].sendsMidi = midiOutputActive && c < numInputs && (perStringAnalysis || c == 0);
+    setLatencySamples(latency);
+    outputDelay.setSize(juce::jmax(1, getTotalNumOutputChannels()), juce::jmax(1, latency));
+    outputDelay.clear();
+    outputDelayPosition = 0;
+
+    // In background mode each channel's FIFO holds one host block plus a bounded amount of extra
+    // latency, and the shared pool can analyse the channels on different cores. MIDI output needs
+    // the results within the block, so it keeps analysis on the audio thread
+    backgroundAnalysisActive = backgroundAnalysisParameter->load() >= 0.5f && ! midiOutputActive;
+    if (backgroundAnalysisActive)
+    {
+        const int capacity = samplesPerBlock + static_cast<int>(sampleRate * maxBackgroundLatencyMs / 1000.0);
+        for (int c = 0; c < numInputs && backgroundAnalysisActive; ++c)
+        {
+            auto& channel = channels[static_cast<size_t>(c)];
+            const double inputSamplesPerHop = channel.tracker.getHopSize() * sampleRate / channel.tracker.getAnalysisSampleRate();
+            const int staleBacklog = static_cast<int>(inputSamplesPerHop + sampleRate * staleResultLatencyMs / 1000.0);
+            backgroundAnalysisActive = channel.worker.start(capacity, staleBacklog, [this, &channel] (const float* samples, int numSamples)
+            {
+                analyseSamples(channel, samples, numSamples);
+            });
+        }
+
+        if (! backgroundAnalysisActive)
+            stopAnalysisWorkers();  // The pool is full: analyse every channel on the audio thread instead
+    }
+
+    prepared = true;
+}
+
+void DefaultAudioProcessor::stopAnalysisWorkers()
+{
+    for (auto& channel : channels)
+        channel.worker.stop();
 }
 
 void DefaultAudioProcessor::releaseResources()
 {
-    // No resources to release in this implementation
+    prepared = false;
+    stopAnalysisWorkers();  // Stop background analysis while the host is not playing
+}
+
+/**
+ * Called when a structural parameter changes, possibly on the audio thread during automation, so
+ * the rebuild is left to the message thread.
+ */
+void DefaultAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(parameterID, newValue);
+    triggerAsyncUpdate();
+}
+
+/**
+ * Rebuilds the analysis for the new structural settings with the same host rate and block size.
+ * Suspending processing keeps processBlock out while the trackers and workers are replaced.
+ */
+void DefaultAudioProcessor::handleAsyncUpdate()
+{
+    if (! prepared || ! analysisSettingsChanged())
+        return;  // Otherwise the host's next prepareToPlay picks the settings up
+
+    suspendProcessing(true);
+    prepareToPlay(getSampleRate(), getBlockSize());
+    suspendProcessing(false);
+}
+
+bool DefaultAudioProcessor::analysisSettingsChanged() const
+{
+    const bool midiOutputSelected = midiOutputParameter->load() >= 0.5f;
+    const bool backgroundSelected = backgroundAnalysisParameter->load() >= 0.5f;
+
+    return getSelectedInstrument() != instrument
+        || getSelectedWindowSize() != analysisWindowSize
+        || getSelectedHopSize() != analysisHopSize
+        || midiOutputSelected != midiOutputActive
+        || (backgroundSelected && ! midiOutputSelected) != backgroundAnalysisActive;
+}
+
+InstrumentModel::Instrument DefaultAudioProcessor::getSelectedInstrument() const
+{
+    const int index = juce::jlimit(0, InstrumentModel::numPresets - 1, static_cast<int>(instrumentParameter->load()));
+    return *InstrumentModel::presets[index];
+}
+
+int DefaultAudioProcessor::getSelectedWindowSize() const
+{
+    const int index = juce::jlimit(0, static_cast<int>(windowSizeChoices.size()) - 1, static_cast<int>(windowSizeParameter->load()));
+    return windowSizeChoices[static_cast<size_t>(index)];
+}
+
+/** The hop never exceeds the window, so every sample is analysed at least once. */
+int DefaultAudioProcessor::getSelectedHopSize() const
+{
+    const int index = juce::jlimit(0, static_cast<int>(hopSizeChoices.size()) - 1, static_cast<int>(hopSizeParameter->load()));
+    return juce::jmin(hopSizeChoices[static_cast<size_t>(index)], getSelectedWindowSize());
+}
+
+/**
+ * Passes the current detector settings to a tracker. Only atomic loads, so it is cheap enough to
+ * run before every analysis call.
+ */
+void DefaultAudioProcessor::applyDetectionSettings(PitchTracker& tracker) const
+{
+    tracker.setNoteTracking(noteTrackingParameter->load(std::memory_order_relaxed) < 0.5f ? PitchTracker::NoteTracking::probabilistic
+                                                                                           : PitchTracker::NoteTracking::stabilityGate);
+    tracker.setDetectionSettings(yinThresholdParameter->load(std::memory_order_relaxed),
+                                 stabilityToleranceParameter->load(std::memory_order_relaxed),
+                                 static_cast<int>(stableFramesParameter->load(std::memory_order_relaxed)));
 }
 
 // Channel Configurations
@@ -123,8 +330,10 @@ bool DefaultAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) c
         return false;  // Only mono and stereo output are supported
 
    #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;  // Input and output layouts must match
+    // Mono, stereo (e.g. DI + mic), or one channel per string from a 4 to 6 string hex/divided pickup
+    const int numInputs = layouts.getMainInputChannelSet().size();
+    if (numInputs != 1 && numInputs != 2 && (numInputs < 4 || numInputs > maxAnalysisChannels))
+        return false;
    #endif
 
     return true;  // Layout is supported
@@ -138,6 +347,8 @@ bool DefaultAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) c
  */
 void DefaultAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    const auto blockStart = CpuProfiler::now();  // Always timed: the flight recorders log each block's duration
+
     juce::ScopedNoDenormals noDenormals;  // Prevents denormals from affecting performance
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -146,113 +357,240 @@ void DefaultAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce:
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // If there is at least one input channel, process the pitch detection
-    if (totalNumInputChannels > 0)
+    // Analyse each input channel here or hand it to its background worker
+    const int numChannels = juce::jmin(totalNumInputChannels, numAnalysedChannels.load(std::memory_order_relaxed));
+    for (int c = 0; c < numChannels; ++c)
     {
-        auto* channelData = buffer.getReadPointer(0);  // Get the data from the first input channel
-        float detectedPitch = pitchDetector->detectPitch(channelData);  // Detect the pitch from the input signal
+        auto& channel = channels[static_cast<size_t>(c)];
+        auto* channelData = buffer.getReadPointer(c);
 
-        // Check if the detected pitch is within the valid range for a bass guitar
-        if (detectedPitch >= 40.0f && detectedPitch <= 400.0f)
-        {
-            // Smooth the pitch detection to avoid jumps and update if stable
-            if (std::abs(detectedPitch - smoothedPitch) < 3.0f || smoothedPitch == 0.0f)
-            {
-                smoothedPitch = 0.7f * smoothedPitch + 0.3f * detectedPitch;  // Apply a smoothing filter
-                stableFrameCount++;
-                if (stableFrameCount >= requiredStableFrames)
-                {
-                    currentPitch = smoothedPitch;  // Update the current pitch if it has been stable
-                    updateCurrentNote(currentPitch);  // Update the current note based on the pitch
-                }
-            }
-            else
-            {
-                stableFrameCount = 0;  // Reset the stability counter if the pitch is unstable
-                smoothedPitch = detectedPitch;  // Update the smoothed pitch immediately
-            }
-        }
+        if (backgroundAnalysisActive)
+            channel.worker.push(channelData, buffer.getNumSamples());
         else
-        {
-            stableFrameCount = 0;  // Reset the stability counter if the pitch is out of range
-            if (smoothedPitch > 0.0f)
-            {
-                smoothedPitch *= 0.9f;  // Apply a slow decay to the smoothed pitch
-                if (smoothedPitch < 30.0f)
-                {
-                    smoothedPitch = 0.0f;  // Reset the pitch if it decays too low
-                    currentPitch = 0.0f;  // Clear the current pitch
-                    currentString = -1;  // Reset string index
-                    currentFret = -1;  // Reset fret index
-                    currentNote = "---";  // Reset note display
-                }
-            }
-        }
+            analyseSamples(channel, channelData, buffer.getNumSamples());
     }
 
-    // Pass the audio through unchanged
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    if (midiOutputActive)
     {
-        auto* channelData = buffer.getWritePointer(channel);
-        juce::ignoreUnused(channelData);  // Unused in this implementation, but necessary to avoid compiler warnings
+        for (auto& channel : channels)
+            if (channel.sendsMidi)
+                channel.midiOutput.renderBlock(midiMessages, inputSamplesProcessed, buffer.getNumSamples());
     }
+    inputSamplesProcessed += buffer.getNumSamples();
+
+    // Pass the audio through unchanged when the layouts match. Otherwise (per-string input, or mono
+    // into stereo) every output gets the sum of the inputs, so the whole instrument stays audible
+    if (totalNumInputChannels > 0 && totalNumInputChannels != totalNumOutputChannels)
+    {
+        for (int c = 1; c < totalNumInputChannels; ++c)
+            buffer.addFrom(0, 0, buffer, c, 0, buffer.getNumSamples());
+        for (int c = 1; c < totalNumOutputChannels; ++c)
+            buffer.copyFrom(c, 0, buffer, 0, 0, buffer.getNumSamples());
+    }
+
+    if (midiOutputActive && getLatencySamples() > 0)
+        delayOutput(buffer, totalNumOutputChannels);
+
+    const auto blockNanoseconds = CpuProfiler::now() - blockStart;
+    lastBlockSize.store(buffer.getNumSamples(), std::memory_order_relaxed);
+    lastBlockMicroseconds.store(static_cast<float>(blockNanoseconds) / 1000.0f, std::memory_order_relaxed);
+
+   #if BASSBUD_PROFILING
+    recordBlockTime(blockNanoseconds, buffer.getNumSamples());
+   #endif
 }
 
 /**
- * Updates the current note, string, and fret based on the detected pitch.
+ * Adds one callback's duration to the histogram and checks it against the deadline: the set
+ * fraction of the time the host has to play the block.
  */
-void DefaultAudioProcessor::updateCurrentNote(float pitch)
+void DefaultAudioProcessor::recordBlockTime(int64_t nanoseconds, int numSamples)
 {
-    const float openStringFrequencies[] = {41.20f, 55.00f, 73.42f, 98.00f};  // Frequencies of the open strings (EADG) on a bass guitar
-    const int numStrings = 4;  // Number of strings on the bass guitar
+    blockTimes[CpuProfiler::Stage::processBlock].record(nanoseconds);
+    if (numSamples <= 0 || getSampleRate() <= 0.0)
+        return;
+
+    const double bufferPeriodNs = numSamples / getSampleRate() * 1.0e9;
+    const auto load = static_cast<float>(static_cast<double>(nanoseconds) / bufferPeriodNs);
+
+    blocksTimed.store(blocksTimed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (load > deadlineFraction.load(std::memory_order_relaxed))
+        deadlineMisses.store(deadlineMisses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (load > peakBlockLoad.load(std::memory_order_relaxed))
+        peakBlockLoad.store(load, std::memory_order_relaxed);
+}
 
-    float minDifference = std::numeric_limits<float>::max();  // Initialize minimum difference to a large value
-    int closestString = -1;  // Initialize the closest string index
+/** Restarts every timing. Only called from prepareToPlay, while nothing is being timed. */
+void DefaultAudioProcessor::clearProfile()
+{
+    blockTimes.clear();
+    for (auto& channel : channels)
+        channel.analysisTimes.clear();
+
+    blocksTimed.store(0);
+    deadlineMisses.store(0);
+    peakBlockLoad.store(0.0f);
+}
 
-    // Find the string with the closest pitch to the detected pitch
-    for (int i = 0; i < numStrings; ++i)
+CpuProfiler::Summary DefaultAudioProcessor::getProfileSummary(CpuProfiler::Stage stage) const
+{
+    CpuProfiler::Summary summary;
+    blockTimes[stage].addTo(summary);
+    for (const auto& channel : channels)
+        channel.analysisTimes[stage].addTo(summary);
+    return summary;
+}
+
+juce::String DefaultAudioProcessor::getProfileReport() const
+{
+    juce::String report = "stage,count,mean_us,p50_us,p99_us,max_us\n";
+
+    for (int s = 0; s < CpuProfiler::numStages; ++s)
     {
-        float difference = std::abs(std::log2(pitch / openStringFrequencies[i]));
-        if (difference < minDifference)
-        {
-            minDifference = difference;
-            closestString = i;  // Update the closest string index
-        }
+        const auto summary = getProfileSummary(static_cast<CpuProfiler::Stage>(s));
+        report << CpuProfiler::stageNames[s] << "," << static_cast<juce::int64>(summary.count) << ","
+               << juce::String(summary.getMeanNanoseconds() / 1000.0, 2) << ","
+               << juce::String(static_cast<double>(summary.getPercentileNanoseconds(0.5)) / 1000.0, 2) << ","
+               << juce::String(static_cast<double>(summary.getPercentileNanoseconds(0.99)) / 1000.0, 2) << ","
+               << juce::String(static_cast<double>(summary.maxNanoseconds) / 1000.0, 2) << "\n";
     }
 
-    currentString = closestString;  // Update the current string
+    report << "blocks,deadline_misses,deadline_fraction,peak_load\n"
+           << static_cast<juce::int64>(getProfiledBlockCount()) << "," << static_cast<juce::int64>(getDeadlineMissCount()) << ","
+           << juce::String(getDeadlineFraction(), 2) << "," << juce::String(getPeakBlockLoad(), 3) << "\n";
+    return report;
+}
 
-    // Calculate the fret number and note name based on the closest string
-    if (currentString != -1)
+/**
+ * Delays the output channels by the reported latency, through a circular buffer per channel.
+ */
+void DefaultAudioProcessor::delayOutput(juce::AudioBuffer<float>& buffer, int numOutputChannels)
+{
+    const int length = outputDelay.getNumSamples();
+    int position = outputDelayPosition;
+
+    for (int c = 0; c < juce::jmin(numOutputChannels, outputDelay.getNumChannels()); ++c)
     {
-        float semitones = 12 * std::log2(pitch / openStringFrequencies[currentString]);  // Calculate the number of semitones from the open string
-        currentFret = std::round(semitones);  // Round to the nearest fret
-        if (currentFret < 0) currentFret = 0;  // Ensure the fret number is non-negative
-        currentNote = frequencyToNoteName(pitch);  // Convert the pitch to a note name
+        auto* samples = buffer.getWritePointer(c);
+        auto* line = outputDelay.getWritePointer(c);
+        position = outputDelayPosition;
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            const float delayed = line[position];
+            line[position] = samples[i];
+            samples[i] = delayed;
+            if (++position == length)
+                position = 0;
+        }
     }
-    else
+
+    outputDelayPosition = position;
+}
+
+/**
+ * Picks the result to display: the sounding channel the detector is most confident about, or
+ * channel 0 if none is sounding.
+ */
+PitchResult DefaultAudioProcessor::getLatestResult() const
+{
+    auto best = channels[0].publishedResult.load();
+
+    for (int c = 1; c < getNumAnalysedChannels(); ++c)
     {
-        currentFret = -1;  // Reset the fret number if no string is found
-        currentNote = "---";  // Reset the note name
+        const auto result = channels[static_cast<size_t>(c)].publishedResult.load();
+        if (result.midiNoteNumber >= 0 && (best.midiNoteNumber < 0 || result.confidence > best.confidence))
+            best = result;
     }
+
+    return best;
+}
+
+uint32_t DefaultAudioProcessor::getAnalysisOverflowCount() const
+{
+    uint32_t total = 0;
+    for (const auto& channel : channels)
+        total += channel.worker.getOverflowCount();
+    return total;
+}
+
+uint32_t DefaultAudioProcessor::getAnalysisUnderrunCount() const
+{
+    uint32_t total = 0;
+    for (const auto& channel : channels)
+        total += channel.worker.getUnderrunCount();
+    return total;
 }
 
 /**
- * Converts a frequency to a musical note name.
+ * Runs a channel's tracker over its input samples and publishes the result after every analysis
+ * frame, and feeds note changes to the channel's MIDI output. In per-string mode the tracker only
+ * knows its own string, so the string index is filled in here. Runs on the audio thread, or on a
+ * pool worker in background mode. Lock- and allocation-free.
  */
-juce::String DefaultAudioProcessor::frequencyToNoteName(float frequency)
+void DefaultAudioProcessor::analyseSamples(ChannelAnalysis& channel, const float* samples, int numSamples)
 {
-    static const char* noteNames[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };  // Note names in an octave
+    applyDetectionSettings(channel.tracker);  // Here, on whichever thread owns the tracker
 
-    float referenceFrequency = 440.0f;  // Frequency of A4 (the reference note)
-    int semitonesFromA4 = std::round(12.0f * std::log2(frequency / referenceFrequency));  // Calculate the number of semitones from A4
+    channel.tracker.process(samples, numSamples, [this, &channel] (const PitchResult& result)
+    {
+        auto published = result;
+        if (channel.stringIndex >= 0 && published.string >= 0)
+            published.string = channel.stringIndex;
+        channel.publishedResult.store(published);
+        recordFrame(channel, published);
+        channel.trail.push({ channel.tracker.getFrameInputSample(), channel.tracker.getLastDetectedPitch(),
+                             published.confidence, published.midiNoteNumber, published.provisional });
+
+        if (channel.sendsMidi)
+            channel.midiOutput.update(result.midiNoteNumber, channel.tracker.getFrameInputSample(),
+                                      channel.tracker.getLastOnsetInputSample(), channel.tracker.getLastOnsetLevelDb());
+    });
+}
+
+/**
+ * Adds the frame the channel's tracker has just finished to its flight recorder. Called from
+ * analyseSamples, on the thread that owns the tracker.
+ */
+void DefaultAudioProcessor::recordFrame(ChannelAnalysis& channel, const PitchResult& published)
+{
+    const auto& tracker = channel.tracker;
+
+    FlightRecorder::Entry entry;
+    entry.frameSample = tracker.getFrameInputSample();
+    entry.rawPitch = tracker.getLastDetectedPitch();
+    entry.trackedPitch = tracker.getTrackedPitch();
+    entry.publishedPitch = published.pitch;
+    entry.cmndMinimum = tracker.getLastCmndMinimum();
+    entry.confidence = published.confidence;
+    entry.voicedProbability = published.voicedProbability;
+    entry.stableFrameCount = static_cast<int16_t>(juce::jmin(tracker.getStableFrameCount(), 32767));
+    entry.midiNoteNumber = static_cast<int8_t>(published.midiNoteNumber);
+    entry.string = static_cast<int8_t>(published.string);
+    entry.fret = static_cast<int8_t>(published.fret);
+    entry.flags = static_cast<uint8_t>((published.provisional ? FlightRecorder::provisional : 0)
+                                       | (tracker.isGateOpen() ? FlightRecorder::gateOpen : 0)
+                                       | (tracker.getNoteTracking() == PitchTracker::NoteTracking::probabilistic ? FlightRecorder::probabilistic : 0));
+    entry.blockSize = lastBlockSize.load(std::memory_order_relaxed);
+    entry.blockMicroseconds = lastBlockMicroseconds.load(std::memory_order_relaxed);
+    channel.recorder.record(entry);
+}
 
-    int noteIndex = (semitonesFromA4 + 9) % 12;  // Calculate the index of the note within the octave (0 = C, 11 = B)
-    if (noteIndex < 0) noteIndex += 12;  // Ensure the note index is non-negative
+FlightRecorder::Recording DefaultAudioProcessor::getFlightRecording() const
+{
+    FlightRecorder::Recording recording;
+    recording.sampleRate = getSampleRate();
+    recording.analysisSampleRate = getAnalysisSampleRate();
+    recording.windowSize = analysisWindowSize;
+    recording.hopSize = analysisHopSize;
 
-    int octave = 4 + (semitonesFromA4 + 9) / 12;  // Calculate the octave number
+    for (int c = 0; c < getNumAnalysedChannels(); ++c)
+    {
+        const auto& channel = channels[static_cast<size_t>(c)];
+        recording.channels.push_back({ c, channel.stringIndex, channel.recorder.snapshot() });
+    }
 
-    return juce::String(noteNames[noteIndex]) + juce::String(octave);  // Return the note name with the octave
+    return recording;
 }
 
 /**
@@ -278,7 +616,11 @@ juce::AudioProcessorEditor* DefaultAudioProcessor::createEditor()
  */
 void DefaultAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::ignoreUnused(destData);  // No state information to save in this implementation
+    if (auto xml = parameters.copyState().createXml())
+    {
+        xml->setAttribute("openGLRendering", isOpenGLRenderingEnabled());  // Editor preference, not a parameter
+        copyXmlToBinary(*xml, destData);
+    }
 }
 
 /**
@@ -287,7 +629,15 @@ void DefaultAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
  */
 void DefaultAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    juce::ignoreUnused(data, sizeInBytes);  // No state information to restore in this implementation
+    auto xml = getXmlFromBinary(data, sizeInBytes);
+    if (xml == nullptr || ! xml->hasTagName(parameters.state.getType()))
+        return;  // Not our state; keep the current settings
+
+    setOpenGLRenderingEnabled(xml->getBoolAttribute("openGLRendering", isOpenGLRenderingEnabled()));
+    xml->removeAttribute("openGLRendering");
+
+    // Structural changes trigger a rebuild through parameterChanged()
+    parameters.replaceState(juce::ValueTree::fromXml(*xml));
 }
 
 /**
@@ -1,11 +1,36 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "YinPitchDetector.h"
+#include "PitchTracker.h"
+#include "SeqLock.h"
+#include "PitchAnalysisWorker.h"
+#include "MidiNoteOutput.h"
+#include "CpuProfiler.h"
+#include "FlightRecorder.h"
+#include "PitchTrailFifo.h"
+#include <array>
+#include <atomic>
 
-class DefaultAudioProcessor  : public juce::AudioProcessor
+class DefaultAudioProcessor  : public juce::AudioProcessor,
+                               private juce::AudioProcessorValueTreeState::Listener,
+                               private juce::AsyncUpdater
 {
 public:
+    /** Parameter IDs, as stored in the saved state. */
+    struct ParameterIDs
+    {
+        static constexpr const char* scale = "scale";
+        static constexpr const char* instrument = "instrument";
+        static constexpr const char* windowSize = "windowSize";
+        static constexpr const char* hopSize = "hopSize";
+        static constexpr const char* noteTracking = "noteTracking";
+        static constexpr const char* yinThreshold = "yinThreshold";
+        static constexpr const char* stabilityTolerance = "stabilityTolerance";
+        static constexpr const char* stableFrames = "stableFrames";
+        static constexpr const char* backgroundAnalysis = "backgroundAnalysis";
+        static constexpr const char* midiOutput = "midiOutput";
+    };
+
     DefaultAudioProcessor();
     ~DefaultAudioProcessor() override;
 
@@ -36,29 +61,180 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-    float getCurrentPitch() const { return currentPitch; }
-    int getCurrentString() const { return currentString; }
-    int getCurrentFret() const { return currentFret; }
-    juce::String getCurrentNote() const { return currentNote; }
+    /**
+     * Every user setting, saved with the session. The detector settings (note tracking, threshold,
+     * stability) apply from the next analysis call. Changing the instrument, window, hop, background analysis or MIDI
+     * output rebuilds the analysis: from the message thread with processing suspended, or at the
+     * host's next prepareToPlay if the processor is not prepared.
+     */
+    juce::AudioProcessorValueTreeState& getParameters() { return parameters; }
+
+    /**
+     * Returns the most recently published detection result. With several input channels this is the
+     * sounding channel with the highest detector confidence. Safe to call from any thread.
+     */
+    PitchResult getLatestResult() const;
+
+    /**
+     * Every input channel up to maxAnalysisChannels gets its own tracker. With one channel per
+     * string (as many inputs as the instrument has strings, from a hex or divided pickup) each
+     * tracker only searches its own string's range and reports that string.
+     */
+    static const int maxAnalysisChannels = InstrumentModel::Instrument::maxStrings;
+    int getNumAnalysedChannels() const { return numAnalysedChannels.load(std::memory_order_relaxed); }
+    bool isPerStringAnalysisActive() const { return perStringAnalysis; }
+
+    /** The latest result of one input channel's tracker. Safe to call from any thread. */
+    PitchResult getLatestChannelResult(int channel) const { return channels[static_cast<size_t>(channel)].publishedResult.load(); }
+
+    /**
+     * Every analysis frame of one input channel, for the editor's pitch trail. Only one thread may
+     * pop from it at a time: the editor's.
+     */
+    PitchTrailFifo& getTrailFifo(int channel) { return channels[static_cast<size_t>(channel)].trail; }
+
+    /**
+     * The analysis frame length and the spacing between frames in use, in samples at the decimated
+     * analysis rate (getAnalysisSampleRate()).
+     */
+    int getAnalysisWindowSize() const { return analysisWindowSize; }
+    int getAnalysisHopSize() const { return analysisHopSize; }
+
+    /**
+     * The instrument notes are mapped onto, shared with the editor's fretboard. This is the
+     * instrument parameter's preset as of the last prepareToPlay; the editor checks it on each
+     * vblank and rebuilds its fretboard when it changes.
+     */
+    const InstrumentModel::Instrument& getInstrument() const { return instrument; }
+
+    /** Rate the detector runs at after decimation; between 5 and 10 kHz for any host rate. */
+    double getAnalysisSampleRate() const { return channels[0].tracker.getAnalysisSampleRate(); }
+
+    /**
+     * True when processBlock only queues input samples and the detector runs on the analysis thread
+     * pool shared by every BassBud instance in the process (AnalysisScheduler). Requested through the
+     * backgroundAnalysis parameter; falls back to the audio thread if the pool is full.
+     */
+    bool isBackgroundAnalysisActive() const { return backgroundAnalysisActive; }
+
+    /**
+     * Whether the editor renders through OpenGL. Kept here, and in the saved state, so the choice
+     * survives the editor being closed and reopened; the editor falls back to software rendering if
+     * OpenGL is unavailable.
+     */
+    void setOpenGLRenderingEnabled(bool shouldBeEnabled) { openGLRenderingEnabled = shouldBeEnabled; }
+    bool isOpenGLRenderingEnabled() const { return openGLRenderingEnabled; }
+
+    /**
+     * True when detected notes are sent as MIDI note-on/off events, one stream per string in
+     * per-string mode. Note-ons are placed a fixed latency after their onsets, which is reported to
+     * the host, and the audio is delayed to match. Analysis then stays on the audio thread even in
+     * background mode. Requested through the midiOutput parameter.
+     */
+    bool isMidiOutputActive() const { return midiOutputActive; }
+
+    /**
+     * CPU profiling, compiled in unless BASSBUD_PROFILING is 0. processBlock and every detector stage
+     * are timed into histograms, and a block is a deadline miss when it takes longer than the
+     * deadline fraction of its buffer period. Everything restarts at prepareToPlay; the getters are
+     * safe to call from any thread.
+     */
+    void setDeadlineFraction(float fraction) { deadlineFraction.store(juce::jlimit(0.01f, 1.0f, fraction)); }
+    float getDeadlineFraction() const { return deadlineFraction.load(); }
+    /** One stage's timings, summed over every channel's tracker. */
+    CpuProfiler::Summary getProfileSummary(CpuProfiler::Stage stage) const;
+    uint64_t getProfiledBlockCount() const { return blocksTimed.load(std::memory_order_relaxed); }
+    uint64_t getDeadlineMissCount() const { return deadlineMisses.load(std::memory_order_relaxed); }
+    /** The longest block so far as a fraction of its buffer period. */
+    float getPeakBlockLoad() const { return peakBlockLoad.load(std::memory_order_relaxed); }
+    /** Every stage's statistics and the deadline counters as CSV, for logs and bug reports. */
+    juce::String getProfileReport() const;
+
+    /**
+     * Every channel's recent detector decisions (see FlightRecorder), oldest first. The recorders
+     * always run; they restart at prepareToPlay. Safe to call from any thread, but allocates.
+     */
+    FlightRecorder::Recording getFlightRecording() const;
+
+    /** Samples dropped because the background worker fell behind. */
+    uint32_t getAnalysisOverflowCount() const;
+    /** Host blocks in which a background worker's result was stale: over a hop plus staleResultLatencyMs behind. */
+    uint32_t getAnalysisUnderrunCount() const;
 
 private:
-    std::unique_ptr<YinPitchDetector> pitchDetector;
-    float currentPitch;
-    int currentString;
-    int currentFret;
-    juce::String currentNote;
-
-    static const int largerBufferSize = 4096;
-    std::vector<float> ringBuffer;
-    int ringBufferPos;
-    int samplesPerBlock;
-
-    float smoothedPitch;
-    int stableFrameCount;
-    static const int requiredStableFrames = 3;
-
-    void updateCurrentNote(float pitch);
-    juce::String frequencyToNoteName(float frequency);
+    /** The analysis state of one input channel. */
+    struct ChannelAnalysis
+    {
+        PitchTracker tracker;  // Decimation, YIN, smoothing and note mapping.
+        SeqLock<PitchResult> publishedResult;  // Audio thread -> editor hand-off of the tracker's result.
+        PitchAnalysisWorker worker;  // Runs analyseSamples off the audio thread in background mode.
+        MidiNoteOutput midiOutput;  // Note events for this channel's notes.
+        bool sendsMidi = false;  // True if midiOutput is in use since the last prepareToPlay.
+        int stringIndex = -1;  // The string this channel carries in per-string mode, or -1.
+        CpuProfiler::StageTimes analysisTimes;  // Detector timings, written by whichever thread runs the tracker.
+        FlightRecorder recorder;  // The tracker's decisions, recorded by that same thread.
+        PitchTrailFifo trail;  // Every frame, pushed by that thread for the editor.
+    };
+
+    juce::AudioProcessorValueTreeState parameters;
+
+    // Parameter values, looked up once so the audio thread and the workers only do atomic loads
+    std::atomic<float>* instrumentParameter = nullptr;
+    std::atomic<float>* windowSizeParameter = nullptr;
+    std::atomic<float>* hopSizeParameter = nullptr;
+    std::atomic<float>* noteTrackingParameter = nullptr;
+    std::atomic<float>* yinThresholdParameter = nullptr;
+    std::atomic<float>* stabilityToleranceParameter = nullptr;
+    std::atomic<float>* stableFramesParameter = nullptr;
+    std::atomic<float>* backgroundAnalysisParameter = nullptr;
+    std::atomic<float>* midiOutputParameter = nullptr;
+
+    static constexpr std::array<int, 4> windowSizeChoices { 256, 512, 1024, 2048 };
+    static constexpr std::array<int, 4> hopSizeChoices { 32, 64, 128, 256 };
+
+    std::array<ChannelAnalysis, maxAnalysisChannels> channels;
+    std::atomic<int> numAnalysedChannels { 1 };  // Channels with a prepared tracker, set in prepareToPlay.
+    bool perStringAnalysis = false;  // True when each input channel is one string.
+
+    // The structural settings in use since the last prepareToPlay
+    int analysisWindowSize = 512;  // About 85 ms at the analysis rate: two periods of low E.
+    int analysisHopSize = 64;  // About 10 ms at the analysis rate.
+    InstrumentModel::Instrument instrument = InstrumentModel::standardBass4;  // Tuning and fret count used for note mapping and display.
+    bool backgroundAnalysisActive = false;
+    bool midiOutputActive = false;
+    std::atomic<bool> prepared { false };  // Between prepareToPlay and releaseResources.
+
+    static constexpr double maxBackgroundLatencyMs = 50.0;  // FIFO headroom beyond one host block.
+    static constexpr double staleResultLatencyMs = 20.0;  // Backlog beyond one hop that counts as an underrun.
+    std::atomic<bool> openGLRenderingEnabled { false };  // Editor rendering mode, read when the editor opens.
+
+    int64_t inputSamplesProcessed = 0;  // Input samples since prepareToPlay: the start of the next block.
+    juce::AudioBuffer<float> outputDelay;  // Delays the audio by the reported latency in MIDI mode.
+    int outputDelayPosition = 0;
+
+    CpuProfiler::StageTimes blockTimes;  // processBlock timings, written by the audio thread.
+    std::atomic<uint64_t> blocksTimed { 0 };  // These three are only written by the audio thread too.
+    std::atomic<uint64_t> deadlineMisses { 0 };
+    std::atomic<float> peakBlockLoad { 0.0f };
+    std::atomic<float> deadlineFraction { 0.5f };
+    std::atomic<int> lastBlockSize { 0 };  // The last completed processBlock, for the flight recorders.
+    std::atomic<float> lastBlockMicroseconds { 0.0f };
+
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    bool analysisSettingsChanged() const;
+    InstrumentModel::Instrument getSelectedInstrument() const;
+    int getSelectedWindowSize() const;
+    int getSelectedHopSize() const;
+    void applyDetectionSettings(PitchTracker& tracker) const;
+
+    void analyseSamples(ChannelAnalysis& channel, const float* samples, int numSamples);
+    void recordFrame(ChannelAnalysis& channel, const PitchResult& published);
+    void stopAnalysisWorkers();
+    void delayOutput(juce::AudioBuffer<float>& buffer, int numOutputChannels);
+    void recordBlockTime(int64_t nanoseconds, int numSamples);
+    void clearProfile();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DefaultAudioProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+/**
+ * Power-of-two real FFT with the same interface and data layout as the real-only transforms of
+ * juce::dsp::FFT, so the detector does not need JUCE.
+ *
+ * A real transform of size N is done as a complex transform of size N / 2 on the even/odd samples
+ * packed as re/im pairs, plus one pass that splits the two spectra apart. Twiddles and the
+ * bit-reversal permutation are built in the constructor; the transforms themselves do not allocate.
+ */
+class RealFFT
+{
+public:
+    explicit RealFFT(int order)
+        : size(1 << order), halfSize(size / 2)
+    {
+        // twiddles[k] = exp(-2 pi i k / size), for k < size / 2. The half-size complex transform
+        // uses every other entry.
+        twiddles.resize(static_cast<size_t>(halfSize));
+        for (int k = 0; k < halfSize; ++k)
+        {
+            const double angle = -2.0 * 3.14159265358979323846 * k / size;
+            twiddles[static_cast<size_t>(k)] = { static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)) };
+        }
+
+        bitReversed.resize(static_cast<size_t>(halfSize));
+        for (int i = 0, j = 0; i < halfSize; ++i)
+        {
+            bitReversed[static_cast<size_t>(i)] = j;
+            int bit = halfSize >> 1;  // Increment j in bit-reversed order.
+            for (; bit > 0 && (j & bit) != 0; bit >>= 1)
+                j ^= bit;
+            j |= bit;
+        }
+    }
+
+    int getSize() const noexcept { return size; }
+
+    /**
+     * Transforms size real samples in data[0, size) into size interleaved complex bins in
+     * data[0, 2 * size), including the mirrored negative frequencies.
+     */
+    void performRealOnlyForwardTransform(float* data) const noexcept
+    {
+        // Samples 2n and 2n + 1 are already laid out as the complex value z[n].
+        auto* z = reinterpret_cast<Complex*>(data);
+        transform(z, false);
+
+        // Split Z into the spectra of the even (E) and odd (O) samples, then X[k] = E[k] + W^k O[k].
+        // Bins k and halfSize - k come from the same pair of Z values, so each pair is done in place.
+        for (int k = 0; k <= halfSize / 2; ++k)
+        {
+            const int j = k == 0 ? 0 : halfSize - k;
+            const Complex a = z[k], b = conj(z[j]);
+            const Complex even { 0.5f * (a.re + b.re), 0.5f * (a.im + b.im) };
+            const Complex odd { 0.5f * (a.im - b.im), -0.5f * (a.re - b.re) };  // (a - b) / 2i
+            const Complex rotated = multiply(twiddles[static_cast<size_t>(k)], odd);
+
+            const Complex low { even.re + rotated.re, even.im + rotated.im };  // X[k]
+            const Complex high { even.re - rotated.re, -(even.im - rotated.im) };  // X[halfSize - k]
+
+            z[k] = low;
+            if (k > 0)
+            {
+                z[size - k] = conj(low);
+                z[halfSize + k] = conj(high);
+            }
+            z[halfSize - k] = high;  // For k == 0 this is the Nyquist bin.
+        }
+    }
+
+    /**
+     * Inverse of performRealOnlyForwardTransform(): takes size interleaved complex bins in
+     * data[0, 2 * size) and leaves the real signal, scaled by 1 / size, in data[0, size).
+     */
+    void performRealOnlyInverseTransform(float* data) const noexcept
+    {
+        auto* z = reinterpret_cast<Complex*>(data);
+
+        // Rebuild the packed spectrum Z[k] = E[k] + i O[k] from X[k] and X[k + halfSize]. Only the
+        // lower half is written, so the upper half is still intact when it is read.
+        for (int k = 0; k < halfSize; ++k)
+        {
+            const Complex a = z[k], b = z[k + halfSize];
+            const Complex even { 0.5f * (a.re + b.re), 0.5f * (a.im + b.im) };
+            const Complex odd = multiply(conj(twiddles[static_cast<size_t>(k)]), { 0.5f * (a.re - b.re), 0.5f * (a.im - b.im) });
+            z[k] = { even.re - odd.im, even.im + odd.re };
+        }
+
+        transform(z, true);
+
+        const float scale = 1.0f / static_cast<float>(halfSize);
+        for (int i = 0; i < size; ++i)
+            data[i] *= scale;
+    }
+
+private:
+    struct Complex
+    {
+        float re, im;
+    };
+
+    static Complex conj(Complex c) noexcept { return { c.re, -c.im }; }
+    static Complex multiply(Complex a, Complex b) noexcept { return { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re }; }
+
+    /** In-place iterative radix-2 complex FFT of halfSize points, unscaled. */
+    void transform(Complex* z, bool inverse) const noexcept
+    {
+        for (int i = 0; i < halfSize; ++i)
+        {
+            const int j = bitReversed[static_cast<size_t>(i)];
+            if (i < j)
+                std::swap(z[i], z[j]);
+        }
+
+        for (int length = 2; length <= halfSize; length <<= 1)
+        {
+            const int half = length / 2;
+            const int stride = size / length;  // Twiddle step for this stage, in units of the size-point table.
+            for (int start = 0; start < halfSize; start += length)
+            {
+                for (int k = 0; k < half; ++k)
+                {
+                    const Complex w = twiddles[static_cast<size_t>(k * stride)];
+                    const Complex v = multiply(inverse ? conj(w) : w, z[start + k + half]);
+                    const Complex u = z[start + k];
+                    z[start + k] = { u.re + v.re, u.im + v.im };
+                    z[start + k + half] = { u.re - v.re, u.im - v.im };
+                }
+            }
+        }
+    }
+
+    int size;
+    int halfSize;
+    std::vector<Complex> twiddles;
+    std::vector<int> bitReversed;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Single-writer sequence lock for publishing small POD values between threads.
+ *
+ * The writer (the audio thread) never blocks or allocates. Readers retry until they see a
+ * sequence number that did not change while copying, so they always get a complete snapshot
+ * rather than a mix of two writes. The payload is stored as atomic words, which keeps the
+ * concurrent copy free of data races.
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payloads must be trivially copyable");
+
+public:
+    SeqLock() { store(T{}); }
+
+    /** Publishes a new value. Must only be called from one thread at a time. */
+    void store(const T& value) noexcept
+    {
+        std::array<uint32_t, numWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);  // Odd: write in progress.
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < numWords; ++i)
+            payload[i].store(words[i], std::memory_order_relaxed);
+
+        sequence.store(seq + 2, std::memory_order_release);  // Even again: write complete.
+    }
+
+    /** Returns the most recently published value. Safe to call from any number of threads. */
+    T load() const noexcept
+    {
+        std::array<uint32_t, numWords> words{};
+        uint32_t before, after;
+
+        do
+        {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < numWords; ++i)
+                words[i] = payload[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1u) != 0 || before != after);
+
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t numWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence { 0 };  // Even when stable, odd while the writer is copying.
+    std::array<std::atomic<uint32_t>, numWords> payload{};  // The value, split into atomic words.
+};
@@ -0,0 +1,285 @@
+#pragma once
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define YIN_KERNELS_X86 1
+ #include <immintrin.h>
+ #if defined(_MSC_VER) && ! defined(__clang__)
+  #include <intrin.h>
+  #define YIN_KERNELS_TARGET_AVX2  // MSVC accepts AVX2 intrinsics without a per-function target.
+ #else
+  #define YIN_KERNELS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+ #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #define YIN_KERNELS_NEON 1
+ #include <arm_neon.h>
+#endif
+
+/**
+ * Inner loops of YinPitchDetector, with a scalar reference version and vectorised versions for
+ * SSE2, AVX2 (+FMA) and NEON. getKernels() picks the widest instruction set the running CPU
+ * supports and getSupportedKernels() lists every one it can run; getScalarKernels() returns the
+ * reference implementations the vector ones must match (to within float rounding, since the
+ * vector versions sum in a different order).
+ */
+namespace YinKernels
+{
+    struct KernelTable
+    {
+        const char* name;
+
+        /** Returns sum over i < n of (a[i] - b[i])^2. */
+        float (*squaredDifferenceSum) (const float* a, const float* b, int n);
+
+        /** Replaces each interleaved (re, im) pair with (re^2 + im^2, 0). */
+        void (*powerSpectrum) (float* interleaved, int numBins);
+
+        /** For tau in [start, end): values[tau] *= tau / runningSums[tau]. */
+        void (*normaliseCmnd) (float* values, const float* runningSums, int start, int end);
+    };
+
+    //==============================================================================
+    namespace Scalar
+    {
+        inline float squaredDifferenceSum(const float* a, const float* b, int n)
+        {
+            float sum = 0.0f;
+            for (int i = 0; i < n; ++i)
+            {
+                const float delta = a[i] - b[i];
+                sum += delta * delta;
+            }
+            return sum;
+        }
+
+        inline void powerSpectrum(float* interleaved, int numBins)
+        {
+            for (int k = 0; k < numBins; ++k)
+            {
+                const float re = interleaved[2 * k];
+                const float im = interleaved[2 * k + 1];
+                interleaved[2 * k] = re * re + im * im;
+                interleaved[2 * k + 1] = 0.0f;
+            }
+        }
+
+        inline void normaliseCmnd(float* values, const float* runningSums, int start, int end)
+        {
+            for (int tau = start; tau < end; ++tau)
+                values[tau] *= tau / runningSums[tau];
+        }
+    }
+
+    //==============================================================================
+   #if YIN_KERNELS_X86
+    namespace SSE2
+    {
+        inline float horizontalSum(__m128 v)
+        {
+            __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+            __m128 sums = _mm_add_ps(v, shuffled);
+            shuffled = _mm_movehl_ps(shuffled, sums);
+            return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+        }
+
+        inline float squaredDifferenceSum(const float* a, const float* b, int n)
+        {
+            __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+                const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+            }
+            return horizontalSum(_mm_add_ps(acc0, acc1)) + Scalar::squaredDifferenceSum(a + i, b + i, n - i);
+        }
+
+        inline void powerSpectrum(float* interleaved, int numBins)
+        {
+            int k = 0;
+            for (; k + 2 <= numBins; k += 2)
+            {
+                const __m128 v = _mm_loadu_ps(interleaved + 2 * k);  // re0 im0 re1 im1
+                const __m128 squared = _mm_mul_ps(v, v);
+                const __m128 swapped = _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1));
+                const __m128 sums = _mm_add_ps(squared, swapped);  // p0 p0 p1 p1
+                const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, -1));
+                _mm_storeu_ps(interleaved + 2 * k, _mm_and_ps(sums, mask));  // p0 0 p1 0
+            }
+            Scalar::powerSpectrum(interleaved + 2 * k, numBins - k);
+        }
+
+        inline void normaliseCmnd(float* values, const float* runningSums, int start, int end)
+        {
+            int tau = start;
+            __m128 taus = _mm_add_ps(_mm_set1_ps(static_cast<float>(tau)), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+            const __m128 step = _mm_set1_ps(4.0f);
+            for (; tau + 4 <= end; tau += 4, taus = _mm_add_ps(taus, step))
+            {
+                const __m128 scale = _mm_div_ps(taus, _mm_loadu_ps(runningSums + tau));
+                _mm_storeu_ps(values + tau, _mm_mul_ps(_mm_loadu_ps(values + tau), scale));
+            }
+            Scalar::normaliseCmnd(values, runningSums, tau, end);
+        }
+    }
+
+    namespace AVX2
+    {
+        YIN_KERNELS_TARGET_AVX2 inline float horizontalSum(__m256 v)
+        {
+            const __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            return SSE2::horizontalSum(sum);
+        }
+
+        YIN_KERNELS_TARGET_AVX2 inline float squaredDifferenceSum(const float* a, const float* b, int n)
+        {
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+            int i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                const __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+                const __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+                acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+                acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+            }
+            return horizontalSum(_mm256_add_ps(acc0, acc1)) + Scalar::squaredDifferenceSum(a + i, b + i, n - i);
+        }
+
+        YIN_KERNELS_TARGET_AVX2 inline void powerSpectrum(float* interleaved, int numBins)
+        {
+            const __m256 mask = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, 0, -1, 0, -1, 0, -1));
+            int k = 0;
+            for (; k + 4 <= numBins; k += 4)
+            {
+                const __m256 v = _mm256_loadu_ps(interleaved + 2 * k);
+                const __m256 squared = _mm256_mul_ps(v, v);
+                const __m256 sums = _mm256_add_ps(squared, _mm256_permute_ps(squared, _MM_SHUFFLE(2, 3, 0, 1)));
+                _mm256_storeu_ps(interleaved + 2 * k, _mm256_and_ps(sums, mask));
+            }
+            Scalar::powerSpectrum(interleaved + 2 * k, numBins - k);
+        }
+
+        YIN_KERNELS_TARGET_AVX2 inline void normaliseCmnd(float* values, const float* runningSums, int start, int end)
+        {
+            int tau = start;
+            __m256 taus = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(tau)),
+                                        _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f));
+            const __m256 step = _mm256_set1_ps(8.0f);
+            for (; tau + 8 <= end; tau += 8, taus = _mm256_add_ps(taus, step))
+            {
+                const __m256 scale = _mm256_div_ps(taus, _mm256_loadu_ps(runningSums + tau));
+                _mm256_storeu_ps(values + tau, _mm256_mul_ps(_mm256_loadu_ps(values + tau), scale));
+            }
+            Scalar::normaliseCmnd(values, runningSums, tau, end);
+        }
+    }
+
+    inline bool cpuSupportsAVX2()
+    {
+       #if defined(_MSC_VER) && ! defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        __cpuid(info, 1);
+        const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+        const bool hasFma = (info[2] & (1 << 12)) != 0;
+
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && hasFma && (info[1] & (1 << 5)) != 0;
+       #else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+       #endif
+    }
+   #endif
+
+    //==============================================================================
+   #if YIN_KERNELS_NEON
+    namespace NEON
+    {
+        inline float squaredDifferenceSum(const float* a, const float* b, int n)
+        {
+            float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+                const float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+                acc0 = vfmaq_f32(acc0, d0, d0);
+                acc1 = vfmaq_f32(acc1, d1, d1);
+            }
+            return vaddvq_f32(vaddq_f32(acc0, acc1)) + Scalar::squaredDifferenceSum(a + i, b + i, n - i);
+        }
+
+        inline void powerSpectrum(float* interleaved, int numBins)
+        {
+            int k = 0;
+            for (; k + 4 <= numBins; k += 4)
+            {
+                float32x4x2_t v = vld2q_f32(interleaved + 2 * k);  // De-interleaves into re and im.
+                v.val[0] = vfmaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]);
+                v.val[1] = vdupq_n_f32(0.0f);
+                vst2q_f32(interleaved + 2 * k, v);
+            }
+            Scalar::powerSpectrum(interleaved + 2 * k, numBins - k);
+        }
+
+        inline void normaliseCmnd(float* values, const float* runningSums, int start, int end)
+        {
+            static const float laneOffsets[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+            int tau = start;
+            float32x4_t taus = vaddq_f32(vdupq_n_f32(static_cast<float>(tau)), vld1q_f32(laneOffsets));
+            const float32x4_t step = vdupq_n_f32(4.0f);
+            for (; tau + 4 <= end; tau += 4, taus = vaddq_f32(taus, step))
+            {
+                const float32x4_t scale = vdivq_f32(taus, vld1q_f32(runningSums + tau));
+                vst1q_f32(values + tau, vmulq_f32(vld1q_f32(values + tau), scale));
+            }
+            Scalar::normaliseCmnd(values, runningSums, tau, end);
+        }
+    }
+   #endif
+
+    //==============================================================================
+    inline const KernelTable& getScalarKernels()
+    {
+        static const KernelTable table { "scalar", Scalar::squaredDifferenceSum, Scalar::powerSpectrum,
+                                         Scalar::normaliseCmnd };
+        return table;
+    }
+
+    /**
+     * Returns every table this build has that the running CPU can execute, scalar first and widest
+     * last, e.g. to check each vector table against the scalar one.
+     */
+    inline std::vector<const KernelTable*> getSupportedKernels()
+    {
+        std::vector<const KernelTable*> tables { &getScalarKernels() };
+
+       #if YIN_KERNELS_X86
+        static const KernelTable sse2 { "sse2", SSE2::squaredDifferenceSum, SSE2::powerSpectrum,
+                                        SSE2::normaliseCmnd };
+        static const KernelTable avx2 { "avx2", AVX2::squaredDifferenceSum, AVX2::powerSpectrum,
+                                        AVX2::normaliseCmnd };
+        tables.push_back(&sse2);
+        if (cpuSupportsAVX2())
+            tables.push_back(&avx2);
+       #elif YIN_KERNELS_NEON
+        static const KernelTable neon { "neon", NEON::squaredDifferenceSum, NEON::powerSpectrum,
+                                        NEON::normaliseCmnd };
+        tables.push_back(&neon);
+       #endif
+
+        return tables;
+    }
+
+    /** Returns the kernels for the widest instruction set available; the CPU is only probed once. */
+    inline const KernelTable& getKernels()
+    {
+        static const KernelTable& best = *getSupportedKernels().back();
+        return best;
+    }
+}
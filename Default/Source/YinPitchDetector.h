@@ -1,119 +1,470 @@
 #pragma once
-#include <JuceHeader.h>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include "YinKernels.h"
+#include "RealFFT.h"
+#include "CpuProfiler.h"
 
 class YinPitchDetector
 {
 public:
-    YinPitchDetector(float sampleRate, int bufferSize)
-        : sampleRate(sampleRate), bufferSize(bufferSize)
+    /** Selects how Step 1 (the difference function) is computed. */
+    enum class DifferenceMethod
+    {
+        fft,         // Autocorrelation via FFT plus prefix-sum energy terms, O(N log N).
+        reference,   // Original direct double loop, O(N^2). Kept for validating the FFT path.
+        incremental  // Updates the previous frame's d(tau) by the samples that entered and left, O(hop * lags).
+    };
+
+    static constexpr float defaultThreshold = 0.03f;  // Step 3 threshold used unless setThreshold() is called.
+
+    YinPitchDetector(float sampleRate, int bufferSize, float minFrequency = 40.0f, float maxFrequency = 400.0f)
+        : sampleRate(sampleRate), bufferSize(bufferSize),
+          fft(fftOrderForBufferSize(bufferSize))
     {
         // Initialize the yinBuffer with the buffer size.
         yinBuffer.resize(bufferSize);
+        filteredBuffer.resize(bufferSize);  // Scratch for detectPitch(), allocated here so the audio thread never does.
         prevSample = 0.0f;  // Initialize previous sample for the low-pass filter.
+
+        // Derive the low-pass coefficient from a cutoff, so the pre-filter behaves the same whatever
+        // rate the detector runs at (at 48 kHz this is the original 0.95 / 0.05 filter).
+        prefilterFeedback = std::exp(-2.0f * 3.14159265f * prefilterCutoffHz / sampleRate);
+        setFrequencyRange(minFrequency, maxFrequency);
+
+        // The FFT plan is created once here (the detector is built in prepareToPlay), so only the
+        // scratch buffers below are touched on the audio thread.
+        fftBuffer.resize(2 * static_cast<size_t>(fft.getSize()));  // Real-only transforms need 2 * fftSize floats.
+        energyPrefix.resize(static_cast<size_t>(bufferSize) + 1);
+        runningSums.resize(bufferSize);
+        slidingDifference.resize(bufferSize);
+        previousFrame.resize(bufferSize);
+    }
+
+    void setDifferenceMethod(DifferenceMethod newMethod)
+    {
+        differenceMethod = newMethod;
+        slidingDifferenceValid = false;
     }
 
+    /**
+     * Restricts detection to [minFrequency, maxFrequency] Hz.
+     * The range is converted to a lag (tau) window, and only the lags inside it (plus the ones the
+     * cumulative mean needs below it) are computed for each frame.
+     */
+    void setFrequencyRange(float newMinFrequency, float newMaxFrequency)
+    {
+        minFrequency = newMinFrequency;
+        maxFrequency = newMaxFrequency;
+
+        // The longest period is capped so that tauMax + 1 (needed for interpolation) stays in the buffer.
+        tauMax = std::min(static_cast<int>(std::ceil(sampleRate / minFrequency)), bufferSize - 2);
+        tauMin = std::max(2, std::min(static_cast<int>(std::floor(sampleRate / maxFrequency)), tauMax));
+        lagLimit = tauMax + 2;
+        slidingDifferenceValid = false;  // The incremental path only holds lags below the old limit.
+    }
+
+    float getMinFrequency() const { return minFrequency; }
+    float getMaxFrequency() const { return maxFrequency; }
+
+    /**
+     * Sets the CMND value a dip must fall below to count as the period (Step 3). Lower values reject
+     * more noisy and inharmonic frames; higher ones find a pitch sooner in weak or decaying notes.
+     * Real-time safe.
+     */
+    void setThreshold(float newThreshold) { threshold = newThreshold; }
+    float getThreshold() const { return threshold; }
+    DifferenceMethod getDifferenceMethod() const { return differenceMethod; }
+
+    /**
+     * Overrides the inner-loop kernels, e.g. with YinKernels::getScalarKernels() to validate the
+     * vectorised ones. Defaults to the widest instruction set the CPU supports.
+     */
+    void setKernels(const YinKernels::KernelTable& newKernels) { kernels = &newKernels; }
+    const YinKernels::KernelTable& getKernels() const { return *kernels; }
+
+    /** Times every step into these histograms from now on; null stops timing. */
+    void setProfile(CpuProfiler::StageTimes* newProfile) { profile = newProfile; }
+
     float detectPitch(const float* buffer)
     {
         // Apply a low-pass filter to the input buffer to reduce high-frequency noise.
-        std::vector<float> filteredBuffer(bufferSize);
-        for (int i = 0; i < bufferSize; ++i)
+        prefilter(buffer, filteredBuffer.data(), bufferSize);
+
+        return detectPitchPrefiltered(filteredBuffer.data());
+    }
+
+    /**
+     * Runs the low-pass pre-filter over a stream of samples.
+     * The filter state carries over between calls, so a signal can be filtered in arbitrary chunks
+     * (e.g. as it arrives from the host) and give exactly the same result as filtering it in one go.
+     * The recurrence stays scalar for that reason: a blocked SIMD version rounds differently
+     * depending on where the chunk boundaries fall.
+     */
+    void prefilter(const float* input, float* output, int numSamples)
+    {
+        BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::prefilter);
+
+        // Low-pass filter formula: filtered[i] = a * previous filtered sample + (1 - a) * current sample
+        const float gain = 1.0f - prefilterFeedback;
+        for (int i = 0; i < numSamples; ++i)
         {
-            // Low-pass filter formula: filtered[i] = 0.95 * previous filtered sample + 0.05 * current sample
-            filteredBuffer[i] = 0.95f * prevSample + 0.05f * buffer[i];
-            prevSample = filteredBuffer[i];  // Update the previous sample for the next iteration.
+            prevSample = prefilterFeedback * prevSample + gain * input[i];
+            output[i] = prevSample;
         }
+    }
+
+    /**
+     * Detects the pitch of a bufferSize-sample frame that has already been through prefilter().
+     * Returns 0 if no pitch in the bass guitar range was found.
+     *
+     * For the incremental method, frameAdvance says how many samples this frame starts after the
+     * previous one passed here (as with overlapping frames from one stream); 0 means the frames are
+     * unrelated and everything is recomputed.
+     */
+    float detectPitchPrefiltered(const float* filteredFrame, int frameAdvance = 0)
+    {
+        pendingFrameAdvance = frameAdvance;
 
         int tauEstimate = -1;  // Estimate of the period (in samples).
         float pitchInHz = 0.0f;  // Detected pitch in Hertz.
 
         // Step 1: Calculate the difference function for the filtered buffer.
-        difference(filteredBuffer.data());
-
-        // Step 2: Calculate the cumulative mean normalized difference function.
-        cumulativeMeanNormalizedDifference();
+        {
+            BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::difference);
+            difference(filteredFrame);
+        }
 
-        // Step 3: Find the first minimum that passes the absolute threshold.
-        tauEstimate = absoluteThreshold();
+        // Steps 2 and 3: Find the first minimum of the cumulative mean normalized difference function
+        // that passes the absolute threshold. The CMND is only computed as far as the search reaches.
+        {
+            BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::threshold);
+            cmndEnd = 0;
+            tauEstimate = absoluteThreshold();
+        }
 
         // Step 4: If a valid tau estimate was found, apply parabolic interpolation for a more accurate estimate.
+        confidence = 0.0f;
         if (tauEstimate != -1) {
+            BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::interpolation);
+            confidence = std::clamp(1.0f - yinBuffer[tauEstimate], 0.0f, 1.0f);  // A deeper dip means a more periodic frame.
             float betterTau = parabolicInterpolation(tauEstimate);
             pitchInHz = sampleRate / betterTau;  // Convert tau to frequency (Hz) using the sample rate.
         }
 
-        // Ensure the detected pitch is within the bass guitar range (40 Hz to 400 Hz).
-        if (pitchInHz < 40.0f || pitchInHz > 400.0f) {
+        // Interpolation can nudge a dip at the edge of the tau window just outside the requested range.
+        if (pitchInHz < minFrequency || pitchInHz > maxFrequency) {
             pitchInHz = 0.0f;  // Discard pitches outside the valid range.
+            confidence = 0.0f;
         }
 
         return pitchInHz;  // Return the detected pitch in Hz.
     }
 
+    int getBufferSize() const { return bufferSize; }
+
+    /** Confidence of the last detection, 1 - CMND at the chosen period; 0 when no pitch was found. */
+    float getConfidence() const { return confidence; }
+
+    /**
+     * Lowest CMND value over the lags searched in the last frame: how near it came to passing the
+     * threshold. A frame with a pitch was only searched up to its dip.
+     */
+    float getCmndMinimum() const
+    {
+        return *std::min_element(yinBuffer.begin() + tauMin, yinBuffer.begin() + std::max(tauMin + 1, std::min(cmndEnd, tauMax + 1)));
+    }
+
+    /** One possible period of the last frame, as used by probabilistic (pYIN) tracking. */
+    struct PitchCandidate
+    {
+        float frequency;  // Hz, after parabolic interpolation.
+        float probability;  // Share of the threshold distribution that picks this dip, 0..1.
+    };
+
+    static constexpr int maxPitchCandidates = 8;
+
+    /**
+     * The pYIN version of Step 3, for the frame last passed to detectPitch(). Instead of one fixed
+     * threshold, the threshold is treated as a random variable with a Beta(2, b) distribution whose
+     * mean is the threshold set with setThreshold() (pYIN itself uses a mean of 0.1), and every dip
+     * of the CMND that would be picked as "the first dip below the threshold" for some threshold
+     * becomes a candidate, weighted by the probability of those thresholds. Thresholds below every
+     * dip give a small share to the deepest dip.
+     * Writes up to maxCandidates candidates in order of period and returns how many were written;
+     * their probabilities sum to the probability that the frame is voiced.
+     */
+    int getPitchCandidates(PitchCandidate* candidates, int maxCandidates)
+    {
+        // Every dip is needed, not just the first, so the rest of the CMND is computed now
+        {
+            BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::cmnd);
+            cumulativeMeanNormalizedDifference(lagLimit);
+        }
+
+        BASSBUD_PROFILE_SCOPE(profile, CpuProfiler::Stage::threshold);
+
+        int numCandidates = 0;
+        float shallowestPicked = 1.0f;  // Thresholds above 1 have no probability.
+
+        for (int tau = tauMin; tau <= tauMax && numCandidates < maxCandidates; ++tau)
+        {
+            // A dip is a local minimum; tauMax + 1 is always computed, for the interpolation
+            const float value = yinBuffer[tau];
+            if (value >= shallowestPicked || value >= yinBuffer[tau - 1] || value > yinBuffer[tau + 1])
+                continue;
+
+            // Picked by every threshold between this dip and the shallowest earlier dip picked
+            const float probability = thresholdDistribution(shallowestPicked) - thresholdDistribution(value);
+            shallowestPicked = value;
+
+            const float frequency = sampleRate / parabolicInterpolation(tau);
+            if (frequency >= minFrequency && frequency <= maxFrequency)
+                candidates[numCandidates++] = { frequency, probability };
+        }
+
+        if (numCandidates > 0)
+            candidates[numCandidates - 1].probability += absoluteMinimumWeight * thresholdDistribution(shallowestPicked);
+
+        return numCandidates;
+    }
+
 private:
+    friend class YinStageBenchmark;  // Times the individual steps below (BassBudTools "bench").
+
     float sampleRate;  // The sample rate of the audio signal.
     int bufferSize;  // The size of the audio buffer to analyze.
     std::vector<float> yinBuffer;  // Buffer used for storing intermediate results of the YIN algorithm.
+    std::vector<float> filteredBuffer;  // Pre-filtered copy of the input used by detectPitch().
     float prevSample;  // The previous sample, used in the low-pass filter.
+    static constexpr float prefilterCutoffHz = 392.0f;  // Approximate -3 dB point of the low-pass pre-filter.
+    float prefilterFeedback = 0.95f;  // Pole of the pre-filter at the current sample rate.
+    float confidence = 0.0f;  // Confidence of the most recent detection.
+
+    float minFrequency = 40.0f;  // Lowest pitch reported, in Hz.
+    float maxFrequency = 400.0f;  // Highest pitch reported, in Hz.
+    float threshold = defaultThreshold;  // CMND level the first accepted dip must fall below.
+    int tauMin = 2;  // Shortest lag searched (period of maxFrequency).
+    int tauMax = 2;  // Longest lag searched (period of minFrequency).
+    int lagLimit = 4;  // Lags [0, lagLimit) are computed; everything above is never read.
+
+    DifferenceMethod differenceMethod = DifferenceMethod::fft;  // Which implementation Step 1 uses.
+    const YinKernels::KernelTable* kernels = &YinKernels::getKernels();  // Inner loops, picked for this CPU.
+    CpuProfiler::StageTimes* profile = nullptr;  // Where steps are timed, or null.
+    std::vector<float> runningSums;  // runningSums[tau] = sum of the difference function over lags 1..tau.
+    int cmndEnd = 0;  // yinBuffer holds the CMND below this lag and the raw difference function from it.
+    static constexpr int cmndChunkLags = 16;  // Lags normalised at a time as the threshold search advances.
+    RealFFT fft;  // FFT plan sized to hold the linear (non-circular) autocorrelation of one buffer.
+    std::vector<float> fftBuffer;  // Scratch for the in-place real-only transforms.
+    std::vector<double> energyPrefix;  // energyPrefix[k] = sum of x[i]^2 for i < k.
+
+    // Incremental path state. d(tau) is carried in double so the per-hop updates do not drift
+    // noticeably between the exact recomputations.
+    static const int incrementalRefreshInterval = 32;  // Frames between exact recomputations.
+    static constexpr double incrementalRefreshEnergyDrop = 0.1;  // Recompute once the energy falls 10 dB.
+    double refreshEnergy = 0.0;  // Frame energy at the last exact recomputation.
+    std::vector<double> slidingDifference;  // d(tau) of the previous frame, for tau < lagLimit.
+    std::vector<float> previousFrame;  // The previous frame, for the pairs that leave the window.
+    bool slidingDifferenceValid = false;  // False until an exact d(tau) has been computed.
+    int framesSinceRefresh = 0;
+    int pendingFrameAdvance = 0;  // frameAdvance of the frame being analysed.
+
+    /** Smallest FFT order whose size is at least 2 * bufferSize, so the circular correlation does not wrap. */
+    static int fftOrderForBufferSize(int size)
+    {
+        int order = 1;
+        while ((1 << order) < 2 * size)
+            ++order;
+        return order;
+    }
 
     /**
      * Step 1: Calculates the difference function of the input buffer.
      * The difference function is part of the YIN algorithm, which compares delayed versions of the signal.
      */
     void difference(const float* buffer)
+    {
+        if (differenceMethod == DifferenceMethod::reference)
+            differenceReference(buffer);
+        else if (differenceMethod == DifferenceMethod::incremental)
+            differenceIncremental(buffer);
+        else
+            differenceFFT(buffer);
+    }
+
+    /**
+     * Step 1 (FFT path): expands d(tau) = sum (x[i] - x[i + tau])^2 over i < N - tau into
+     * energy(0, N - tau) + energy(tau, N) - 2 * r(tau), where the energies come from a prefix sum
+     * of x^2 and the autocorrelation r(tau) is the inverse FFT of the power spectrum.
+     */
+    void differenceFFT(const float* buffer)
+    {
+        const int fftSize = fft.getSize();
+
+        // Zero-pad the frame to fftSize and accumulate the squared-sample prefix sums.
+        energyPrefix[0] = 0.0;
+        for (int i = 0; i < bufferSize; ++i)
+        {
+            fftBuffer[i] = buffer[i];
+            energyPrefix[i + 1] = energyPrefix[i] + static_cast<double>(buffer[i]) * buffer[i];
+        }
+        std::fill(fftBuffer.begin() + bufferSize, fftBuffer.end(), 0.0f);
+
+        // Power spectrum |X(k)|^2, stored back as purely real bins.
+        fft.performRealOnlyForwardTransform(fftBuffer.data());
+        kernels->powerSpectrum(fftBuffer.data(), fftSize);
+
+        // The (normalised) inverse transform leaves r(tau) in the first fftSize samples.
+        fft.performRealOnlyInverseTransform(fftBuffer.data());
+
+        const double totalEnergy = energyPrefix[bufferSize];
+        yinBuffer[0] = 0;
+        for (int tau = 1; tau < lagLimit; tau++) {
+            const double energy = energyPrefix[bufferSize - tau] + (totalEnergy - energyPrefix[tau]);
+            const double value = energy - 2.0 * fftBuffer[tau];
+            yinBuffer[tau] = value > 0.0 ? static_cast<float>(value) : 0.0f;  // Clamp rounding noise below zero.
+        }
+    }
+
+    /**
+     * Step 1 (reference path): the original direct evaluation of the difference function.
+     * Quadratic in bufferSize; used to validate differenceFFT().
+     */
+    void differenceReference(const float* buffer)
     {
         // Initialize the yinBuffer to zero.
-        for (int tau = 0; tau < bufferSize; tau++) {
+        for (int tau = 0; tau < lagLimit; tau++) {
             yinBuffer[tau] = 0;
         }
 
-        // Calculate the squared difference for each lag (tau).
-        for (int tau = 1; tau < bufferSize; tau++) {
-            for (int i = 0; i < bufferSize - tau; i++) {
-                float delta = buffer[i] - buffer[i + tau];
-                yinBuffer[tau] += delta * delta;  // Accumulate the squared differences.
+        // Calculate the squared difference for each lag (tau) up to the end of the search window.
+        for (int tau = 1; tau < lagLimit; tau++) {
+            yinBuffer[tau] = kernels->squaredDifferenceSum(buffer, buffer + tau, bufferSize - tau);  // Accumulate the squared differences.
+        }
+    }
+
+    /**
+     * Step 1 (incremental path): when this frame starts a samples after the previous one, the pairs
+     * (x[i], x[i + tau]) that left the window are those with i < a in the previous frame, and the
+     * ones that entered are those with i + tau >= N - a in this frame. Each lag is updated by those
+     * 2a terms instead of being summed over the whole window. Falls back to differenceFFT() for the
+     * first frame, unrelated frames, large advances, and every incrementalRefreshInterval frames.
+     *
+     * The updates carry rounding error relative to the level at the last exact computation, so a
+     * note dying away would soon be swamped by it; the exact path also runs whenever the frame
+     * energy has dropped by more than incrementalRefreshEnergyDrop since then.
+     */
+    void differenceIncremental(const float* buffer)
+    {
+        const int advance = pendingFrameAdvance;
+
+        double energy = 0.0;
+        for (int i = 0; i < bufferSize; ++i)
+            energy += static_cast<double>(buffer[i]) * buffer[i];
+
+        if (! slidingDifferenceValid || advance <= 0 || advance > bufferSize / 2
+             || ++framesSinceRefresh >= incrementalRefreshInterval
+             || energy < refreshEnergy * incrementalRefreshEnergyDrop)
+        {
+            differenceFFT(buffer);
+            std::copy(yinBuffer.begin(), yinBuffer.begin() + lagLimit, slidingDifference.begin());
+            slidingDifferenceValid = true;
+            framesSinceRefresh = 0;
+            refreshEnergy = energy;
+        }
+        else
+        {
+            const float* previous = previousFrame.data();
+            yinBuffer[0] = 0;
+
+            for (int tau = 1; tau < lagLimit; ++tau)
+            {
+                const int numPairs = bufferSize - tau;
+                const int numLeft = std::min(advance, numPairs);
+                const int firstEntered = std::max(0, numPairs - advance);
+
+                const float left = kernels->squaredDifferenceSum(previous, previous + tau, numLeft);
+                const float entered = kernels->squaredDifferenceSum(buffer + firstEntered, buffer + firstEntered + tau, numPairs - firstEntered);
+
+                slidingDifference[tau] += static_cast<double>(entered) - left;
+                yinBuffer[tau] = slidingDifference[tau] > 0.0 ? static_cast<float>(slidingDifference[tau]) : 0.0f;
             }
         }
+
+        std::copy(buffer, buffer + bufferSize, previousFrame.begin());
     }
 
     /**
-     * Step 2: Calculates the cumulative mean normalized difference function (CMND).
+     * Step 2: Calculates the cumulative mean normalized difference function (CMND) for every lag
+     * below endLag not yet normalised, carrying on from where the last call for this frame stopped.
      * This function normalizes the difference function to help identify the period of the signal.
      */
-    void cumulativeMeanNormalizedDifference()
+    void cumulativeMeanNormalizedDifference(int endLag)
     {
-        float runningSum = 0;  // Running sum of differences.
-        yinBuffer[0] = 1;  // Set the first value of the CMND to 1 (as per the YIN algorithm).
+        endLag = std::min(endLag, lagLimit);
+        if (cmndEnd == 0)
+        {
+            yinBuffer[0] = 1;  // Set the first value of the CMND to 1 (as per the YIN algorithm).
+            runningSums[0] = 0;
+            cmndEnd = 1;
+        }
+        if (endLag <= cmndEnd)
+            return;
 
-        // Calculate the cumulative mean normalized difference.
-        for (int tau = 1; tau < bufferSize; tau++) {
+        // The running sum is inherently sequential, so it is gathered first and the division by the
+        // running mean (the costly part) is done in a separate, vectorised pass. The running mean needs
+        // every lag from 1, but nothing beyond the search window.
+        float runningSum = runningSums[cmndEnd - 1];  // Running sum of differences.
+        for (int tau = cmndEnd; tau < endLag; tau++) {
             runningSum += yinBuffer[tau];
-            yinBuffer[tau] *= tau / runningSum;  // Normalize the difference by the running mean.
+            runningSums[tau] = runningSum;
         }
+        kernels->normaliseCmnd(yinBuffer.data(), runningSums.data(), cmndEnd, endLag);  // Normalize each difference by the running mean.
+        cmndEnd = endLag;
+    }
+
+    /** The CMND at tau, computing it (and a few lags after it) if the search has not reached it yet. */
+    float getCmnd(int tau)
+    {
+        if (tau >= cmndEnd)
+            cumulativeMeanNormalizedDifference(tau + cmndChunkLags);
+        return yinBuffer[tau];
     }
 
     /**
      * Step 3: Finds the first minimum value in the CMND that is below a given threshold.
-     * This method is used to estimate the period of the signal.
+     * This method is used to estimate the period of the signal. The CMND is computed as the search
+     * goes, so the lags after the first confirmed dip are never normalised.
      */
     int absoluteThreshold()
     {
-        float threshold = 0.03f;  // Threshold for detecting the first minimum. Lower threshold increases sensitivity.
-
-        // Search for the first value in the CMND that is below the threshold.
-        for (int tau = 2; tau < bufferSize; tau++) {
-            if (yinBuffer[tau] < threshold) {
+        // Search the tau window for the first value in the CMND that is below the threshold.
+        for (int tau = tauMin; tau <= tauMax; tau++) {
+            if (getCmnd(tau) < threshold) {
                 // Continue to the next tau if the current value decreases further.
-                while (tau + 1 < bufferSize && yinBuffer[tau + 1] < yinBuffer[tau]) {
+                while (tau + 1 < lagLimit && getCmnd(tau + 1) < yinBuffer[tau]) {
                     tau++;
                 }
-                return tau;  // Return the tau value corresponding to the first minimum.
+                return tau;  // The dip is confirmed once the CMND rises again; no later lag is examined.
             }
         }
         return -1;  // Return -1 if no valid tau value is found.
     }
 
+    static constexpr float absoluteMinimumWeight = 0.01f;  // pYIN's weight for thresholds below every dip, given to the deepest one.
+
+    /**
+     * Cumulative Beta(2, b) distribution of the pYIN threshold, 1 - (1 - x)^b (1 + bx), with b chosen
+     * so that the mean 2 / (2 + b) is the detector's threshold.
+     */
+    float thresholdDistribution(float value) const
+    {
+        const float b = 2.0f / std::clamp(threshold, 0.001f, 0.5f) - 2.0f;
+        const float x = std::clamp(value, 0.0f, 1.0f);
+        return 1.0f - std::pow(1.0f - x, b) * (1.0f + b * x);
+    }
+
     /**
      * Step 4: Refines the tau estimate using parabolic interpolation.
      * This method improves the accuracy of the pitch estimate by interpolating between points in the CMND.
@@ -122,7 +473,7 @@ private:
     {
         float betterTau;
         int x0 = (tauEstimate < 1) ? tauEstimate : tauEstimate - 1;  // Ensure x0 is within bounds.
-        int x2 = (tauEstimate + 1 < bufferSize) ? tauEstimate + 1 : tauEstimate;  // Ensure x2 is within bounds.
+        int x2 = (tauEstimate + 1 < lagLimit) ? tauEstimate + 1 : tauEstimate;  // Ensure x2 is within bounds.
 
         // Handle the edge case where tauEstimate is at the boundary.
         if (x0 == tauEstimate)